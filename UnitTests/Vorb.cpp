@@ -4,9 +4,105 @@
 #undef UNIT_TEST_BATCH
 #define UNIT_TEST_BATCH Vorb_
 
+#include <chrono>
+#include <thread>
+
 #include <include/Vorb.h>
+#include <include/Vorb/AssetLoader.h>
+
+namespace {
+    class TestAsset : public vcore::Asset {
+    public:
+        // Empty
+    };
+
+    /// Records the builder calls made by a loader
+    struct AssetCalls {
+    public:
+        std::mutex lock;
+        std::vector<nString> created;
+        std::vector<nString> destroyed;
+    };
+    AssetCalls assetCalls;
+}
+
+namespace vorb {
+    namespace core {
+        template<>
+        struct AssetBuilder<TestAsset> {
+        public:
+            void create(const vpath& path, TestAsset* asset, vcore::RPCManager& rpc VORB_UNUSED) {
+                // Assets named "free" are not counted against the budget
+                asset->memoryCost = path.getString() == "free" ? 0 : 100;
+                std::lock_guard<std::mutex> lock(assetCalls.lock);
+                assetCalls.created.push_back(asset->name);
+            }
+            void destroy(TestAsset* asset) {
+                std::lock_guard<std::mutex> lock(assetCalls.lock);
+                assetCalls.destroyed.push_back(asset->name);
+            }
+        };
+    }
+}
+
+namespace {
+    CONTEXTUAL_ASSET_LOADER(TestAssetLoader, TestAsset);
+
+    bool waitForLoad(const TestAsset* asset) {
+        for (int i = 0; i < 1000 && !asset->isLoaded; i++) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return asset->isLoaded;
+    }
+}
 
 TEST(InitDispose) {
     if (vorb::init(vorb::InitParam::ALL) != vorb::InitParam::ALL) return false;
     return vorb::dispose(vorb::InitParam::ALL) == vorb::InitParam::ALL;
+}
+
+TEST(AssetResidency) {
+    assetCalls.created.clear();
+    assetCalls.destroyed.clear();
+
+    TestAssetLoader loader;
+    const char* names[5] = { "a", "b", "c", "d", "z" };
+    TestAsset* assets[5];
+    for (size_t i = 0; i < 5; i++) {
+        assets[i] = loader.load(names[i], i == 4 ? "free" : names[i]);
+        test_assert(waitForLoad(assets[i]));
+    }
+    test_assert(loader.getResidentMemory() == 400);
+
+    // Use b, c and d in successive frames, so b is the least recently used
+    loader.updateGL();
+    loader.get("b");
+    loader.updateGL();
+    loader.get("c");
+    loader.updateGL();
+    loader.get("d");
+    loader.pin("a");
+
+    // a is pinned, d was used this frame and z costs nothing, so b then c go
+    loader.setMemoryBudget(250);
+    loader.updateGL();
+    test_assert(assetCalls.destroyed.size() == 2);
+    test_assert(assetCalls.destroyed[0] == "b" && assetCalls.destroyed[1] == "c");
+    test_assert(assets[0]->isLoaded && !assets[1]->isLoaded && !assets[2]->isLoaded);
+    test_assert(assets[3]->isLoaded && assets[4]->isLoaded);
+    test_assert(loader.getResidentMemory() == 200);
+
+    // Asking for an evicted asset reloads it on the next update, into the same object
+    test_assert(loader.get("b") == assets[1]);
+    test_assert(!assets[1]->isLoaded);
+    loader.updateGL();
+    test_assert(waitForLoad(assets[1]));
+    test_assert(assetCalls.created.size() == 6 && assetCalls.created[5] == "b");
+    test_assert(loader.getResidentMemory() == 300);
+
+    // Evicted assets are not destroyed twice
+    loader.freeAll();
+    test_assert(assetCalls.destroyed.size() == 6);
+    test_assert(std::count(assetCalls.destroyed.begin(), assetCalls.destroyed.end(), "c") == 1);
+    return true;
 }
\ No newline at end of file
@@ -8,6 +8,12 @@
 #include <include/graphics/ModelIO.h>
 #include <include/graphics/ImageIO.h>
 #include <include/io/IOManager.h>
+#include <include/Vorb/io/BufferedStream.h>
+#include <include/Vorb/io/Compression.h>
+#include <include/Vorb/io/Directory.h>
+#include <include/Vorb/io/FileOps.h>
+#include <include/Vorb/io/Hash.h>
+#include <include/Vorb/io/PackFile.h>
 #include <include/Vorb.h>
 #include <include/Timing.h>
 #include "tiny_obj_loader.h"
@@ -249,4 +255,307 @@ TEST(ImageIO) {
     }
     vorb::dispose(vorb::InitParam::ALL);
     return true;
+}
+
+TEST(CompressionRoundTrip) {
+    std::vector<ui8> runs(100000), noise(5000), empty;
+    for (size_t i = 0; i < runs.size(); i++) runs[i] = (ui8)(i / 1000);
+    for (size_t i = 0; i < noise.size(); i++) noise[i] = (ui8)rand();
+
+    const std::vector<ui8>* inputs[3] = { &runs, &noise, &empty };
+    for (const std::vector<ui8>* input : inputs) {
+        std::vector<ui8> compressed(vio::compressBound(input->size()));
+        size_t compressedSize = vio::compressBlock(input->data(), input->size(), compressed.data(), compressed.size());
+        test_assert(compressedSize > 0);
+
+        std::vector<ui8> output(input->size());
+        test_assert(vio::decompressBlock(compressed.data(), compressedSize, output.data(), output.size()) == input->size());
+        test_assert(output == *input);
+        if (input == &runs) test_assert(compressedSize < runs.size() / 10);
+    }
+    return true;
+}
+
+TEST(CompressionMalformed) {
+    std::vector<ui8> input(10000);
+    for (size_t i = 0; i < input.size(); i++) input[i] = (ui8)((i / 100) * 7);
+    std::vector<ui8> compressed(vio::compressBound(input.size()));
+    size_t compressedSize = vio::compressBlock(input.data(), input.size(), compressed.data(), compressed.size());
+    test_assert(compressedSize > 0);
+
+    // Too little room on either side
+    std::vector<ui8> output(input.size());
+    test_assert(vio::compressBlock(input.data(), input.size(), compressed.data(), 8) == 0);
+    test_assert(vio::decompressBlock(compressed.data(), compressedSize, output.data(), output.size() - 1) == 0);
+
+    // Truncated blocks never produce the whole output
+    for (size_t cut = 0; cut < compressedSize; cut++) {
+        test_assert(vio::decompressBlock(compressed.data(), cut, output.data(), output.size()) != input.size());
+    }
+
+    // A match reaching before the start of the output
+    const ui8 badOffset[] = { 0x10, 'a', 0x05, 0x00 };
+    test_assert(vio::decompressBlock(badOffset, sizeof(badOffset), output.data(), output.size()) == 0);
+
+    // Garbage must stay within the buffers
+    std::vector<ui8> garbage(256);
+    for (int i = 0; i < 10000; i++) {
+        for (size_t j = 0; j < garbage.size(); j++) garbage[j] = (ui8)rand();
+        test_assert(vio::decompressBlock(garbage.data(), garbage.size(), output.data(), 512) <= 512);
+    }
+    return true;
+}
+
+TEST(Hash64) {
+    // Reference XXH64 values
+    test_assert(vio::hash64(nString("")) == 0xEF46DB3751D8E999ull);
+    test_assert(vio::hash64(nString("a")) == 0xD24EC4F1A98C6E5Bull);
+    test_assert(vio::hash64(nString("abc")) == 0x44BC2CF5AD770999ull);
+    test_assert(vio::hash64(nString("Nobody inspects the spammish repetition")) == 0xFBCEA83C8A378BF1ull);
+
+    // Seeds change the result, and a null pointer is fine for empty input
+    test_assert(vio::hash64(nString(""), 1) != vio::hash64(nString("")));
+    test_assert(vio::hash64(nullptr, 0) == 0xEF46DB3751D8E999ull);
+    return true;
+}
+
+TEST(PackFile) {
+    vpath path = "test/test.vpak";
+    nString text;
+    for (int i = 0; i < 1000; i++) text += "Packed text line\n";
+    std::vector<ui8> noise(5000);
+    for (size_t i = 0; i < noise.size(); i++) noise[i] = (ui8)rand();
+
+    vio::PackWriter writer;
+    test_assert(writer.open(path));
+    test_assert(writer.add("data\\text.txt", text.data(), text.size()));
+    test_assert(writer.add("./noise.bin", noise.data(), noise.size(), false));
+    test_assert(!writer.add("data/text.txt", text.data(), text.size()));
+    test_assert(writer.finish());
+
+    vio::PackFile pack;
+    test_assert(pack.open(path));
+    test_assert(pack.getEntryCount() == 2);
+    test_assert(pack.contains("data/text.txt") && pack.contains("noise.bin"));
+    test_assert(!pack.contains("missing.txt"));
+
+    // Compressed files are read, stored ones may also be viewed in place
+    std::vector<ui8> data;
+    test_assert(pack.read("data/text.txt", data));
+    test_assert(nString(data.begin(), data.end()) == text);
+    test_assert(pack.find("data/text.txt")->storedSize < text.size());
+    size_t size;
+    test_assert(pack.view("data/text.txt", size) == nullptr);
+    const ui8* view = pack.view("noise.bin", size);
+    test_assert(view && size == noise.size() && memcmp(view, noise.data(), size) == 0);
+
+    vfstream stream = pack.openStream("data/text.txt");
+    test_assert(stream.isOpened());
+    std::vector<char> streamed(text.size());
+    test_assert(stream.read(text.size(), 1, streamed.data()) == text.size());
+    test_assert(memcmp(streamed.data(), text.data(), text.size()) == 0);
+    stream.close();
+    pack.close();
+
+    // Cutting off the index must be caught at open
+    std::vector<ui8> bytes;
+    FILE* file = fopen(path.getCString(), "rb");
+    test_assert(file != nullptr);
+    int c;
+    while ((c = fgetc(file)) != EOF) bytes.push_back((ui8)c);
+    fclose(file);
+    file = fopen(path.getCString(), "wb");
+    fwrite(bytes.data(), 1, bytes.size() - 16, file);
+    fclose(file);
+    test_assert(!pack.open(path));
+
+    // As must a damaged magic
+    bytes[0] ^= 0xFF;
+    file = fopen(path.getCString(), "wb");
+    fwrite(bytes.data(), 1, bytes.size(), file);
+    fclose(file);
+    test_assert(!pack.open(path));
+    remove(path.getCString());
+    return true;
+}
+
+TEST(MatchGlob) {
+    // Exact and empty patterns
+    test_assert(vio::Directory::matchGlob("a/b.txt", "a/b.txt"));
+    test_assert(!vio::Directory::matchGlob("a/b.txt", "a/b.txt2"));
+    test_assert(vio::Directory::matchGlob("", ""));
+    test_assert(!vio::Directory::matchGlob("", "a"));
+    test_assert(!vio::Directory::matchGlob("a", ""));
+
+    // '*' stays within a directory
+    test_assert(vio::Directory::matchGlob("*.png", "a.png"));
+    test_assert(vio::Directory::matchGlob("*.png", ".png"));
+    test_assert(!vio::Directory::matchGlob("*.png", "a/b.png"));
+    test_assert(vio::Directory::matchGlob("a/*/c", "a/b/c"));
+    test_assert(!vio::Directory::matchGlob("a/*/c", "a/b/d/c"));
+    test_assert(vio::Directory::matchGlob("*", "abc"));
+    test_assert(!vio::Directory::matchGlob("*", "a/b"));
+
+    // "**" crosses directories, and "**/" may match none
+    test_assert(vio::Directory::matchGlob("**.png", "a/b/c.png"));
+    test_assert(vio::Directory::matchGlob("**/*.png", "a/b/c.png"));
+    test_assert(vio::Directory::matchGlob("**/*.png", "c.png"));
+    test_assert(vio::Directory::matchGlob("a/**/c", "a/c"));
+    test_assert(vio::Directory::matchGlob("a/**/c", "a/b/d/c"));
+    test_assert(!vio::Directory::matchGlob("**/*.png", "a/b/c.jpg"));
+
+    // '?' is exactly one character other than '/'
+    test_assert(vio::Directory::matchGlob("?.txt", "a.txt"));
+    test_assert(!vio::Directory::matchGlob("?.txt", ".txt"));
+    test_assert(!vio::Directory::matchGlob("?.txt", "ab.txt"));
+    test_assert(!vio::Directory::matchGlob("a?b", "a/b"));
+    return true;
+}
+
+TEST(StreamReaderMemory) {
+    const char text[] = "one\ntwo\nthree";
+    vio::StreamReader reader(text, sizeof(text) - 1);
+
+    // Peeking never consumes, and can't reach past the end
+    test_assert(reader.peek(sizeof(text)) == nullptr);
+    const ui8* bytes = reader.peek(3);
+    test_assert(bytes && memcmp(bytes, "one", 3) == 0);
+    test_assert(reader.getOffset() == 0);
+
+    size_t size;
+    bytes = reader.peekUntil('\n', size);
+    test_assert(bytes && size == 4 && memcmp(bytes, "one\n", 4) == 0);
+    reader.consume(size);
+    bytes = reader.peekUntil('\n', size);
+    test_assert(bytes && size == 4 && memcmp(bytes, "two\n", 4) == 0);
+    reader.consume(size);
+
+    // The last line has no delimiter and runs to the end
+    bytes = reader.peekUntil('\n', size);
+    test_assert(bytes && size == 5 && memcmp(bytes, "three", 5) == 0);
+    test_assert(!reader.isEOF());
+    reader.consume(size);
+    test_assert(reader.isEOF());
+    test_assert(reader.peekUntil('\n', size) == nullptr);
+    reader.peekAvailable(size);
+    test_assert(size == 0);
+    test_assert(reader.peek(1) == nullptr);
+    test_assert(reader.getOffset() == sizeof(text) - 1);
+
+    // Empty memory ends at once
+    vio::StreamReader empty(text, 0);
+    test_assert(empty.isEOF());
+    test_assert(empty.peek(1) == nullptr);
+    test_assert(empty.peekUntil('\n', size) == nullptr);
+    return true;
+}
+
+TEST(StreamReaderFile) {
+    // Lines of growing length, so spans straddle refills of a small buffer
+    std::vector<ui8> data;
+    for (size_t i = 0; i < 40; i++) {
+        for (size_t j = 0; j < i; j++) data.push_back((ui8)('a' + (i + j) % 26));
+        data.push_back('\n');
+    }
+    size_t dataSize = data.size();
+
+    vpath path = "test/stream.bin";
+    vfile file;
+    test_assert(path.asFile(&file));
+    vfstream fs = file.create(false);
+    test_assert(fs.isOpened());
+    test_assert(fs.write(dataSize, 1, data.data()) == dataSize);
+    fs.close();
+
+    const size_t CAPACITY = 16;
+    ui8 buffer[CAPACITY];
+    fs = file.openReadOnly(false);
+    test_assert(fs.isOpened());
+    vio::StreamReader reader(fs, buffer, CAPACITY);
+
+    // A peek larger than the buffer always fails, the buffer itself is fine
+    test_assert(reader.peek(CAPACITY + 1) == nullptr);
+    test_assert(reader.peek(CAPACITY) != nullptr);
+
+    // Lines that fit are returned whole, even when they were split across reads
+    size_t offset = 0, size;
+    for (size_t i = 0; i < CAPACITY; i++) {
+        const ui8* line = reader.peekUntil('\n', size);
+        test_assert(line && size == i + 1);
+        test_assert(memcmp(line, data.data() + offset, size) == 0);
+        reader.consume(size);
+        offset += size;
+        test_assert(reader.getOffset() == offset);
+    }
+
+    // A line longer than the buffer can't be peeked, but can be read
+    test_assert(reader.peekUntil('\n', size) == nullptr);
+    std::vector<ui8> line(CAPACITY + 1);
+    test_assert(reader.read(line.data(), line.size()) == line.size());
+    test_assert(memcmp(line.data(), data.data() + offset, line.size()) == 0);
+    offset += line.size();
+
+    // Peeks may need the unconsumed bytes moved down to fit
+    test_assert(reader.skip(1) == 1);
+    offset++;
+    const ui8* bytes = reader.peek(CAPACITY);
+    test_assert(bytes && memcmp(bytes, data.data() + offset, CAPACITY) == 0);
+
+    // Reads larger than the buffer bypass it
+    std::vector<ui8> rest(dataSize);
+    size_t copied = reader.read(rest.data(), 100);
+    test_assert(copied == 100);
+    test_assert(memcmp(rest.data(), data.data() + offset, copied) == 0);
+    offset += copied;
+
+    // Reads and skips past the end stop short
+    test_assert(reader.skip(10) == 10);
+    offset += 10;
+    copied = reader.read(rest.data(), dataSize);
+    test_assert(copied == dataSize - offset);
+    test_assert(memcmp(rest.data(), data.data() + offset, copied) == 0);
+    test_assert(reader.isEOF());
+    test_assert(reader.read(rest.data(), 1) == 0);
+    test_assert(reader.skip(1) == 0);
+    test_assert(reader.peek(1) == nullptr);
+    test_assert(reader.peekUntil('\n', size) == nullptr);
+    test_assert(reader.getOffset() == dataSize);
+    fs.close();
+    remove(path.getCString());
+    return true;
+}
+
+TEST(PathCacheStale) {
+    vpath directory = "test";
+    directory.makeAbsolute();
+    vio::IOManager iom(directory);
+    vpath path = "stale";
+    vpath absolutePath = directory / path;
+    remove(absolutePath.getCString());
+    vio::IOManager::invalidatePathCache();
+
+    // Cache the file as found
+    FILE* file = fopen(absolutePath.getCString(), "w");
+    test_assert(file != nullptr);
+    fclose(file);
+    test_assert(iom.fileExists(path));
+
+    // Deleting it outside of a manager must not leave it resolving
+    remove(absolutePath.getCString());
+    test_assert(!iom.fileExists(path));
+    vpath resolved;
+    test_assert(!iom.resolvePath(path, resolved));
+
+    // Nor must replacing it with a directory
+    file = fopen(absolutePath.getCString(), "w");
+    test_assert(file != nullptr);
+    fclose(file);
+    test_assert(iom.fileExists(path));
+    remove(absolutePath.getCString());
+    test_assert(vio::buildDirectoryTree(absolutePath));
+    test_assert(!iom.fileExists(path));
+    test_assert(iom.directoryExists(path));
+    remove(absolutePath.getCString());
+    test_assert(!iom.directoryExists(path));
+    return true;
 }
\ No newline at end of file
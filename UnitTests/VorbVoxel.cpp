@@ -5,9 +5,20 @@
 #define UNIT_TEST_BATCH Vorb_Voxel_
 
 #include <include/voxel/IntervalTree.h>
+#include <include/Vorb/voxel/ChunkMeshPipeline.h>
+#include <include/Vorb/voxel/PaletteContainer.h>
+#include <include/Vorb/voxel/RegionFile.h>
+#include <include/Vorb/voxel/VoxelLight.h>
+#include <include/Vorb/voxel/VoxelRaycast.h>
+#include <include/Vorb/voxel/VoxelMesherCulled.h>
+#include <include/Vorb/voxel/VoxelMesherGreedy.h>
 #include <include/Vorb.h>
 #include <include/Timing.h>
 
+#include <random>
+#include <thread>
+#include <tuple>
+
 TEST(IntervalTree) {
     
     // Ordered insertion
@@ -75,4 +86,703 @@ TEST(IntervalTree) {
 
     std::cout << tree.size() << std::endl;
     return true;
+}
+
+TEST(IntervalTreeLookup) {
+    IntervalTree<ui16> tree;
+    std::vector<ui16> reference(32768, 0);
+    tree.initSingle(0, 32768);
+    for (int i = 0; i < 100000; i++) {
+        int index = rand() % 32768;
+        ui16 data = rand() % 4;
+        tree.insert(index, data);
+        reference[index] = data;
+    }
+    test_assert(!tree.isLookupValid());
+
+    tree.updateLookup();
+    test_assert(tree.isLookupValid());
+    for (int i = 0; i < 32768; i++) {
+        test_assert(tree.getData(i) == reference[i]);
+    }
+
+    // Time lookups through both paths
+    const IntervalTree<ui16>& constTree = tree;
+    const int LOOKUPS = 1000000;
+    int a = 0;
+    PreciseTimer timer;
+    for (int i = 0; i < LOOKUPS; i++) {
+        a += constTree.getData(rand() % 32768);
+    }
+    printf("Avg flat lookup time %lf ms\n", timer.stop() / LOOKUPS);
+
+    tree.insert(0, reference[0]);
+    test_assert(!tree.isLookupValid());
+    timer.start();
+    for (int i = 0; i < LOOKUPS; i++) {
+        a += constTree.getData(rand() % 32768);
+    }
+    printf("Avg tree lookup time %lf ms\n", timer.stop() / LOOKUPS);
+    std::cout << a << std::endl;
+    return true;
+}
+
+TEST(IntervalTreeLarge) {
+    // 64^3 chunks need 32-bit starts and lengths
+    const size_t LENGTH = 64 * 64 * 64;
+    IntervalTree<ui16, ui32> tree;
+    std::vector<ui16> reference(LENGTH, 0);
+    tree.initSingle(0, LENGTH);
+    for (int i = 0; i < 1000000; i++) {
+        size_t index = ((size_t)rand() * RAND_MAX + rand()) % LENGTH;
+        ui16 data = rand() % 8;
+        tree.insert(index, data);
+        reference[index] = data;
+    }
+    test_assert(tree.checkTreeValidity());
+    test_assert(tree.length() == LENGTH);
+
+    for (size_t i = 0; i < LENGTH; i++) {
+        test_assert(tree.getData(i) == reference[i]);
+    }
+    std::cout << tree.size() << std::endl;
+    return true;
+}
+
+TEST(IntervalTreeBatch) {
+    IntervalTree<ui16> tree;
+    std::vector<ui16> reference(32768, 0);
+    tree.initSingle(0, 32768);
+
+    std::vector<std::pair<size_t, ui16> > writes;
+    for (int i = 0; i < 100000; i++) {
+        size_t index = rand() % 32768;
+        ui16 data = (index / 1024) % 2;
+        writes.emplace_back(index, data);
+        reference[index] = data;
+    }
+    tree.insertBatch(writes);
+    test_assert(tree.checkTreeValidity());
+
+    // Batched writes must leave no adjacent runs with equal data
+    size_t runs = 1;
+    for (size_t i = 1; i < reference.size(); i++) {
+        if (reference[i] != reference[i - 1]) runs++;
+    }
+    test_assert(tree.size() == runs);
+    for (size_t i = 0; i < reference.size(); i++) {
+        test_assert(tree.getData(i) == reference[i]);
+    }
+
+    // Fragment with single inserts, then recombine
+    for (int i = 0; i < 10000; i++) {
+        size_t index = rand() % 32768;
+        tree.insert(index, reference[index]);
+    }
+    tree.recombine();
+    test_assert(tree.checkTreeValidity());
+    test_assert(tree.size() == runs);
+    return true;
+}
+
+TEST(IntervalTreeFlatArray) {
+    const size_t LENGTH = 32768;
+    std::vector<ui16> noisy(LENGTH), layered(LENGTH), result(LENGTH);
+    for (size_t i = 0; i < LENGTH; i++) {
+        noisy[i] = rand() % 4;
+        layered[i] = (i / 1024) < 10 ? 1 : 0;
+    }
+
+    IntervalTree<ui16> tree;
+    const int ITERATIONS = 1000;
+    PreciseTimer timer;
+    for (int i = 0; i < ITERATIONS; i++) {
+        tree.initFromFlatArray(layered.data(), LENGTH);
+        tree.uncompressIntoBuffer(result.data());
+    }
+    printf("Avg layered round trip %lf ms\n", timer.stop() / ITERATIONS);
+    test_assert(tree.checkTreeValidity());
+    test_assert(tree.size() == 2);
+    test_assert(result == layered);
+
+    timer.start();
+    for (int i = 0; i < ITERATIONS; i++) {
+        tree.initFromFlatArray(noisy.data(), LENGTH);
+        tree.uncompressIntoBuffer(result.data());
+    }
+    printf("Avg noisy round trip %lf ms\n", timer.stop() / ITERATIONS);
+    test_assert(tree.checkTreeValidity());
+    test_assert(result == noisy);
+    for (size_t i = 0; i < LENGTH; i++) {
+        test_assert(tree.getData(i) == noisy[i]);
+    }
+    return true;
+}
+
+TEST(RegionFile) {
+    vpath path = "test/region.vrgn";
+    remove(path.getCString());
+
+    IntervalTree<ui16> tree;
+    tree.initSingle(0, 32768);
+    for (int i = 0; i < 2000; i++) {
+        tree.insert(rand() % 32768, rand() % 4);
+    }
+    std::vector<ui8> noise(3000);
+    for (size_t i = 0; i < noise.size(); i++) noise[i] = (ui8)rand();
+
+    vvox::RegionFile region;
+    test_assert(region.open(path, 32));
+    test_assert(region.writeTree(3, tree));
+    test_assert(region.write(7, noise.data(), noise.size()));
+    test_assert(!region.write(32, noise.data(), noise.size()));
+    region.close();
+
+    // Slot counts must match when reopening
+    test_assert(!region.open(path, 16));
+    test_assert(region.open(path, 32));
+    IntervalTree<ui16> loaded;
+    test_assert(region.readTree(3, loaded));
+    test_assert(loaded.length() == tree.length());
+    for (size_t i = 0; i < tree.length(); i++) {
+        test_assert(loaded.getData(i) == tree.getData(i));
+    }
+    std::vector<ui8> data;
+    test_assert(region.read(7, data) && data == noise);
+    test_assert(!region.has(5) && !region.read(5, data));
+
+    // Runs that are empty or sum past the largest tree must be rejected
+    ui16 zeroRun[4] = { 100, 1, 0, 2 };
+    test_assert(region.write(4, zeroRun, sizeof(zeroRun)));
+    test_assert(!region.readTree(4, loaded));
+    ui16 longRuns[4] = { 30000, 1, 30000, 2 };
+    test_assert(region.write(4, longRuns, sizeof(longRuns)));
+    test_assert(!region.readTree(4, loaded));
+    test_assert(region.erase(4));
+
+    // Replaced blobs are wasted until compaction
+    test_assert(region.write(7, noise.data(), 100));
+    test_assert(region.getWastedBytes() > 0);
+    test_assert(region.compact());
+    test_assert(region.getWastedBytes() == 0);
+    test_assert(region.read(7, data) && data.size() == 100 && memcmp(data.data(), noise.data(), 100) == 0);
+    region.close();
+
+    // Point slot 7 past the end of the file
+    FILE* file = fopen(path.getCString(), "rb+");
+    test_assert(file != nullptr);
+    vvox::RegionSlot slot;
+    fseek(file, 16 + 7 * sizeof(vvox::RegionSlot), SEEK_SET);
+    test_assert(fread(&slot, sizeof(slot), 1, file) == 1);
+    slot.offset += 1ull << 32;
+    fseek(file, 16 + 7 * sizeof(vvox::RegionSlot), SEEK_SET);
+    fwrite(&slot, sizeof(slot), 1, file);
+    fclose(file);
+    test_assert(!region.open(path, 32));
+
+    // Damage the magic
+    file = fopen(path.getCString(), "rb+");
+    test_assert(file != nullptr);
+    fputc(0, file);
+    fclose(file);
+    test_assert(!region.open(path, 32));
+    remove(path.getCString());
+    return true;
+}
+
+TEST(PaletteContainerRepack) {
+    const size_t LENGTH = 4096;
+    std::vector<ui32> reference(LENGTH, 0);
+    vvox::PaletteContainer<ui32> container;
+    container.init(LENGTH, 0);
+    test_assert(container.getBitsPerIndex() == 1);
+
+    // Indices widen only as far as the palette needs
+    for (ui32 value = 1; value < 300; value++) {
+        size_t index = rand() % LENGTH;
+        container.set(index, value);
+        reference[index] = value;
+        ui32 bits = container.getBitsPerIndex();
+        test_assert(((size_t)1 << bits) >= container.getPaletteSize());
+        test_assert(bits == 1 || ((size_t)1 << (bits - 1)) < container.getPaletteSize());
+    }
+    for (size_t i = 0; i < LENGTH; i++) {
+        test_assert(container.get(i) == reference[i]);
+    }
+
+    // Compacting drops dead entries and narrows the indices
+    for (size_t i = 0; i < LENGTH; i++) {
+        reference[i] = (i % 64) ? 7 : 8;
+        container.set(i, reference[i]);
+    }
+    test_assert(container.getBitsPerIndex() == 9);
+    container.compact();
+    test_assert(container.getPaletteSize() == 2);
+    test_assert(container.getBitsPerIndex() == 1);
+    for (size_t i = 0; i < LENGTH; i++) {
+        test_assert(container.get(i) == reference[i]);
+    }
+
+    // A full palette reclaims the entry of the voxel being replaced
+    const size_t FULL = vvox::PaletteContainer<ui32>::MAX_PALETTE_SIZE;
+    std::vector<ui32> distinct(FULL);
+    for (size_t i = 0; i < FULL; i++) distinct[i] = (ui32)i * 3;
+    container.initFromFlatArray(distinct.data(), FULL);
+    test_assert(container.getPaletteSize() == FULL);
+    container.set(5, 1);
+    distinct[5] = 1;
+    test_assert(container.getPaletteSize() == FULL);
+    for (size_t i = 0; i < FULL; i++) {
+        test_assert(container.get(i) == distinct[i]);
+    }
+
+    // Round trip through an IntervalTree
+    IntervalTree<ui32, ui32> tree;
+    container.toIntervalTree(tree);
+    vvox::PaletteContainer<ui32> copy;
+    copy.initFromIntervalTree(tree);
+    std::vector<ui32> result(FULL);
+    copy.uncompressIntoBuffer(result.data());
+    test_assert(result == distinct);
+    return true;
+}
+
+namespace {
+    /// Solid voxels are non-zero, and only equal voxels merge
+    class TestMeshAPI {
+    public:
+        vvox::meshalg::VoxelFaces occludes(const ui16& v1, const ui16& v2, const vvox::Axis& axis) {
+            vvox::meshalg::VoxelFaces faces;
+            faces.block1Face = v1 && !v2;
+            faces.block2Face = v2 && !v1;
+            return faces;
+        }
+        bool mergeable(const ui16& v1, const ui16& v2, const vvox::Cardinal& direction) {
+            return v1 == v2;
+        }
+        bool isOpaque(const ui16& v) {
+            return v != 0;
+        }
+        void result(const vvox::meshalg::VoxelQuad& quad) {
+            quads.push_back(quad);
+        }
+
+        std::vector<vvox::meshalg::VoxelQuad> quads;
+    };
+
+    typedef std::tuple<ui32, ui32, ui32, int> TestFace; ///< Voxel position and direction
+
+    /// Fill a padded chunk with rolling terrain of two materials and some noise
+    std::vector<ui16> makeTestChunk(const ui32v3& size) {
+        std::vector<ui16> data(size.x * size.y * size.z, 0);
+        for (ui32 y = 1; y < size.y - 1; y++) {
+            for (ui32 z = 1; z < size.z - 1; z++) {
+                for (ui32 x = 1; x < size.x - 1; x++) {
+                    ui32 height = 10 + (ui32)(4 * sin(x * 0.2) + 3 * cos(z * 0.15));
+                    ui16 v = y < height ? (y + 3 < height ? 1 : 2) : 0;
+                    if (rand() % 9 == 0) v = v ? 0 : 3;
+                    data[y * size.x * size.z + z * size.x + x] = v;
+                }
+            }
+        }
+        return data;
+    }
+
+    std::multiset<TestFace> getCulledFaces(const std::vector<ui16>& data, const ui32v3& size) {
+        TestMeshAPI api;
+        vvox::meshalg::createCulled(data.data(), size, &api);
+        std::multiset<TestFace> faces;
+        for (auto& quad : api.quads) {
+            faces.emplace(quad.voxelPosition.x, quad.voxelPosition.y, quad.voxelPosition.z, (int)quad.direction);
+        }
+        return faces;
+    }
+}
+
+TEST(GreedyMatchesCulled) {
+    // In-plane axes of quad sizes, see createGreedy
+    static const ui32v2 PLANE_AXES[3] = { ui32v2(2, 1), ui32v2(0, 2), ui32v2(0, 1) };
+
+    ui32v3 size(34, 30, 34);
+    std::vector<ui16> data = makeTestChunk(size);
+    std::multiset<TestFace> culled = getCulledFaces(data, size);
+
+    // Expanded back into single faces, the greedy quads cover exactly the culled faces
+    TestMeshAPI api;
+    vvox::meshalg::createGreedy(data.data(), size, &api);
+    std::multiset<TestFace> greedy;
+    for (auto& quad : api.quads) {
+        size_t axis = (size_t)quad.direction >> 1;
+        const ui16& first = data[quad.startIndex];
+        for (ui32 u = 0; u < quad.size.x; u++) {
+            for (ui32 v = 0; v < quad.size.y; v++) {
+                ui32v3 pos = quad.voxelPosition;
+                pos[PLANE_AXES[axis].x] += u;
+                pos[PLANE_AXES[axis].y] += v;
+                test_assert(data[pos.y * size.x * size.z + pos.z * size.x + pos.x] == first);
+                greedy.emplace(pos.x, pos.y, pos.z, (int)quad.direction);
+            }
+        }
+    }
+    test_assert(greedy == culled);
+    test_assert(api.quads.size() < culled.size());
+    return true;
+}
+
+TEST(MaskedMatchesCulled) {
+    // Sizes below and above the 64 voxel columns
+    ui32v3 sizes[3] = { ui32v3(18, 14, 18), ui32v3(34, 30, 66), ui32v3(70, 20, 70) };
+    for (const ui32v3& size : sizes) {
+        std::vector<ui16> data = makeTestChunk(size);
+        std::multiset<TestFace> culled = getCulledFaces(data, size);
+
+        TestMeshAPI api;
+        vvox::meshalg::createCulledMasked(data.data(), size, &api);
+        std::multiset<TestFace> masked;
+        for (auto& quad : api.quads) {
+            const ui32v3& pos = quad.voxelPosition;
+            test_assert(quad.startIndex == pos.y * size.x * size.z + pos.z * size.x + pos.x);
+            masked.emplace(pos.x, pos.y, pos.z, (int)quad.direction);
+        }
+        test_assert(masked == culled);
+    }
+    return true;
+}
+
+
+namespace {
+    /// Vertices that record the face they came from
+    class TestMeshPolicy {
+    public:
+        typedef TestFace Vertex;
+
+        vvox::meshalg::VoxelFaces occludes(const ui16& v1, const ui16& v2, const vvox::Axis& axis) {
+            return api.occludes(v1, v2, axis);
+        }
+        void generateQuad(const vvox::meshalg::ChunkView<ui16>& view, const vvox::meshalg::VoxelQuad& quad, OUT Vertex* vertices) {
+            for (size_t i = 0; i < 4; i++) {
+                vertices[i] = TestFace(quad.voxelPosition.x, quad.voxelPosition.y, quad.voxelPosition.z, (int)quad.direction);
+            }
+        }
+
+        TestMeshAPI api;
+    };
+}
+
+TEST(ChunkMeshPipeline) {
+    const size_t CHUNKS = 12;
+    const size_t MAX_IN_FLIGHT = 4;
+    typedef vvox::ChunkMeshPipeline<ui16, TestMeshPolicy> Pipeline;
+
+    ui32v3 size(16, 16, 16);
+    std::vector<std::vector<ui16> > chunks(CHUNKS);
+    std::vector<Pipeline::Job> jobs(CHUNKS);
+    for (size_t i = 0; i < CHUNKS; i++) {
+        chunks[i] = makeTestChunk(size);
+        jobs[i].id = i;
+        jobs[i].view.data = chunks[i].data();
+        jobs[i].view.size = size;
+    }
+
+    Pipeline pipeline;
+    pipeline.init(TestMeshPolicy(), 3, MAX_IN_FLIGHT);
+
+    // Jobs past the limit are refused until results are polled
+    test_assert(pipeline.trySubmit(jobs.data(), CHUNKS) == MAX_IN_FLIGHT);
+    test_assert(pipeline.getInFlight() == MAX_IN_FLIGHT);
+    test_assert(pipeline.trySubmit(jobs.data() + MAX_IN_FLIGHT, CHUNKS - MAX_IN_FLIGHT) == 0);
+
+    // The rest block in submit while this thread polls
+    std::thread submitter([&] {
+        pipeline.submit(jobs.data() + MAX_IN_FLIGHT, CHUNKS - MAX_IN_FLIGHT);
+    });
+    std::vector<Pipeline::Result> results;
+    bool withinLimit = true;
+    for (int wait = 0; results.size() < CHUNKS && wait < 10000; wait++) {
+        withinLimit = withinLimit && pipeline.getInFlight() <= MAX_IN_FLIGHT;
+        Pipeline::Result result;
+        if (pipeline.poll(result)) {
+            results.push_back(std::move(result));
+        } else {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+    submitter.join();
+    test_assert(withinLimit);
+    test_assert(results.size() == CHUNKS);
+    test_assert(pipeline.getInFlight() == 0);
+    test_assert(pipeline.getChunksMeshed() == CHUNKS);
+
+    // Every chunk comes back once, with the faces of a serial createCulled
+    std::vector<int> seen(CHUNKS, 0);
+    for (auto& result : results) {
+        test_assert(result.id < CHUNKS);
+        seen[(size_t)result.id]++;
+
+        TestMeshAPI api;
+        vvox::meshalg::createCulled(jobs[(size_t)result.id].view, &api);
+        std::multiset<TestFace> expected;
+        for (auto& quad : api.quads) {
+            expected.emplace(quad.voxelPosition.x, quad.voxelPosition.y, quad.voxelPosition.z, (int)quad.direction);
+        }
+        test_assert(result.vertices.size() == api.quads.size() * 4);
+        std::multiset<TestFace> faces;
+        for (size_t i = 0; i < result.vertices.size(); i += 4) faces.insert(result.vertices[i]);
+        test_assert(faces == expected);
+    }
+    for (int count : seen) test_assert(count == 1);
+    pipeline.destroy();
+    return true;
+}
+
+namespace {
+    /// Walls and emitters of a light test chunk
+    class TestLightWorld {
+    public:
+        TestLightWorld(const ui32v3& s) :
+            size(s),
+            opaque(s.x * s.y * s.z, 0),
+            emission(s.x * s.y * s.z, 0) {
+            // Sparse walls from a fixed hash, so every storage sees the same chunk
+            for (size_t i = 0; i < opaque.size(); i++) {
+                opaque[i] = ((i * 2654435761u) >> 7) % 8 == 0;
+            }
+        }
+
+        size_t toIndex(const ui32v3& pos) const {
+            return pos.y * size.x * size.z + pos.z * size.x + pos.x;
+        }
+
+        /// Compare storage against lighting the chunk from scratch
+        template<typename Storage>
+        bool matches(Storage& storage) const {
+            std::vector<ui8> fresh(opaque.size(), 0);
+            vvox::FlatLightStorage<Blocks> freshStorage(fresh.data(), Blocks(this));
+            vvox::LightPropagator propagator(size);
+            propagator.relightAll(freshStorage);
+            for (size_t i = 0; i < fresh.size(); i++) {
+                if (storage.getLight(i) != fresh[i]) return false;
+            }
+            return true;
+        }
+
+        /// Block queries for the storages
+        class Blocks {
+        public:
+            Blocks(const TestLightWorld* world) :
+                m_world(world) {
+                // Empty
+            }
+
+            bool isOpaque(size_t index) const { return m_world->opaque[index] != 0; }
+            ui8 getEmission(size_t index) const { return m_world->emission[index]; }
+        private:
+            const TestLightWorld* m_world;
+        };
+
+        ui32v3 size;
+        std::vector<ui8> opaque;
+        std::vector<ui8> emission;
+    };
+
+    template<typename Blocks>
+    void flushLight(vvox::FlatLightStorage<Blocks>& storage VORB_UNUSED) {
+        // Writes are immediate
+    }
+    template<typename Blocks, typename S>
+    void flushLight(vvox::IntervalTreeLightStorage<Blocks, S>& storage) {
+        storage.flush();
+    }
+
+    /// Edit emitters and walls, comparing with a fresh propagation after every edit
+    template<typename Storage>
+    bool checkLightEdits(TestLightWorld& world, Storage& storage) {
+        ui32v3 lamp(3, 3, 3), torch(12, 9, 11), wall(6, 4, 4);
+        world.opaque[world.toIndex(lamp)] = 0;
+        world.opaque[world.toIndex(torch)] = 0;
+        world.opaque[world.toIndex(wall)] = 0;
+
+        vvox::LightPropagator propagator(world.size);
+        world.emission[world.toIndex(lamp)] = vvox::MAX_LIGHT_LEVEL;
+        propagator.relightAll(storage);
+        flushLight(storage);
+        if (storage.getLight(world.toIndex(wall)) == 0 || !world.matches(storage)) return false;
+
+        // Add a second light
+        world.emission[world.toIndex(torch)] = 12;
+        propagator.onBlockPlaced(storage, torch);
+        flushLight(storage);
+        if (!world.matches(storage)) return false;
+
+        // Block the first light, then open it again
+        world.opaque[world.toIndex(wall)] = 1;
+        propagator.onBlockPlaced(storage, wall);
+        flushLight(storage);
+        if (storage.getLight(world.toIndex(wall)) != 0 || !world.matches(storage)) return false;
+        world.opaque[world.toIndex(wall)] = 0;
+        propagator.onBlockRemoved(storage, wall);
+        flushLight(storage);
+        if (!world.matches(storage)) return false;
+
+        // Remove both lights, leaving the chunk dark
+        world.emission[world.toIndex(torch)] = 0;
+        propagator.onBlockRemoved(storage, torch);
+        flushLight(storage);
+        if (!world.matches(storage)) return false;
+        world.emission[world.toIndex(lamp)] = 0;
+        propagator.onBlockRemoved(storage, lamp);
+        flushLight(storage);
+        for (size_t i = 0; i < world.opaque.size(); i++) {
+            if (storage.getLight(i) != 0) return false;
+        }
+        return true;
+    }
+}
+
+TEST(LightPropagation) {
+    ui32v3 size(16, 16, 16);
+
+    TestLightWorld flatWorld(size);
+    std::vector<ui8> light(size.x * size.y * size.z, 0);
+    vvox::FlatLightStorage<TestLightWorld::Blocks> flat(light.data(), TestLightWorld::Blocks(&flatWorld));
+    test_assert(checkLightEdits(flatWorld, flat));
+
+    TestLightWorld treeWorld(size);
+    IntervalTree<ui8> tree;
+    tree.initSingle(0, size.x * size.y * size.z);
+    vvox::IntervalTreeLightStorage<TestLightWorld::Blocks> treeStorage(&tree, TestLightWorld::Blocks(&treeWorld));
+    test_assert(checkLightEdits(treeWorld, treeStorage));
+    test_assert(treeStorage.getPendingWrites() == 0);
+    test_assert(tree.checkTreeValidity());
+    return true;
+}
+
+TEST(FaceAO) {
+    // A 3x3 plane of voxels in front of a face, u along x and v along y
+    ui8 opaque[9] = {};
+    ui8 ao = vvox::meshalg::computeFaceAO(opaque, 4, 1, 3);
+    test_assert(ao == 0xFF);
+
+    // One side darkens the two corners next to it
+    opaque[3] = 1;
+    ao = vvox::meshalg::computeFaceAO(opaque, 4, 1, 3);
+    test_assert(vvox::meshalg::getCornerAO(ao, 0) == 2 && vvox::meshalg::getCornerAO(ao, 1) == 3);
+    test_assert(vvox::meshalg::getCornerAO(ao, 2) == 2 && vvox::meshalg::getCornerAO(ao, 3) == 3);
+
+    // Two sides fully occlude the corner between them
+    opaque[1] = 1;
+    ao = vvox::meshalg::computeFaceAO(opaque, 4, 1, 3);
+    test_assert(vvox::meshalg::getCornerAO(ao, 0) == 0 && vvox::meshalg::getCornerAO(ao, 1) == 2);
+    test_assert(vvox::meshalg::getCornerAO(ao, 2) == 2 && vvox::meshalg::getCornerAO(ao, 3) == 3);
+
+    // A lone diagonal only darkens its own corner
+    memset(opaque, 0, sizeof(opaque));
+    opaque[8] = 1;
+    ao = vvox::meshalg::computeFaceAO(opaque, 4, 1, 3);
+    test_assert(vvox::meshalg::getCornerAO(ao, 3) == 2);
+    test_assert(vvox::meshalg::getCornerAO(ao, 0) == 3 && vvox::meshalg::getCornerAO(ao, 1) == 3 && vvox::meshalg::getCornerAO(ao, 2) == 3);
+    return true;
+}
+
+namespace {
+    struct TestIsSolid {
+    public:
+        bool operator()(const ui16& v) const { return v != 0; }
+    };
+
+    const f32 BRUTE_STEP = 1e-3f;
+
+    /// Sample the ray at small fixed steps for the first solid voxel
+    vvox::VoxelRaycastResult bruteRaycast(const std::vector<ui16>& data, const ui32v3& size, const vvox::VoxelRay& ray) {
+        vvox::VoxelRaycastResult result;
+        size_t steps = (size_t)(ray.maxDistance / BRUTE_STEP);
+        for (size_t i = 0; i <= steps; i++) {
+            f32 t = i * BRUTE_STEP;
+            f32v3 p = ray.origin + ray.direction * t;
+            if (p.x < 0.0f || p.y < 0.0f || p.z < 0.0f) continue;
+            ui32v3 voxel((ui32)p.x, (ui32)p.y, (ui32)p.z);
+            if (voxel.x >= size.x || voxel.y >= size.y || voxel.z >= size.z) continue;
+            if (data[(voxel.y * size.z + voxel.z) * size.x + voxel.x]) {
+                result.hit = true;
+                result.voxel = voxel;
+                result.distance = t;
+                return result;
+            }
+        }
+        return result;
+    }
+
+    bool sameHit(const vvox::VoxelRaycastResult& a, const vvox::VoxelRaycastResult& brute) {
+        if (a.hit != brute.hit) return false;
+        if (!a.hit) return true;
+        return a.voxel == brute.voxel && a.distance <= brute.distance + 1e-4f && brute.distance - a.distance <= 2.0f * BRUTE_STEP;
+    }
+}
+
+TEST(Raycast) {
+    ui32v3 size(32, 16, 32);
+    std::vector<ui16> data(size.x * size.y * size.z, 0);
+    auto at = [&] (ui32 x, ui32 y, ui32 z) -> ui16& {
+        return data[(y * size.z + z) * size.x + x];
+    };
+    // A floor, one wall run along x, and random runs in the far half
+    for (ui32 z = 0; z < size.z; z++) {
+        for (ui32 x = 0; x < size.x; x++) {
+            for (ui32 y = 0; y < 4; y++) at(x, y, z) = 1;
+        }
+    }
+    for (ui32 x = 20; x < 24; x++) at(x, 4, 8) = 2;
+    std::mt19937 random(1234);
+    for (int i = 0; i < 60; i++) {
+        ui32 x = random() % (size.x - 6), y = 4 + random() % (size.y - 4), z = 16 + random() % (size.z - 16);
+        ui32 length = 1 + random() % 6;
+        for (ui32 j = 0; j < length; j++) at(x + j, y, z) = 3;
+    }
+
+    IntervalTree<ui16> tree;
+    tree.initFromFlatArray(data.data(), data.size());
+    vvox::FlatRaycastAccessor<ui16, TestIsSolid> flat(data.data(), size, TestIsSolid());
+    vvox::IntervalTreeRaycastAccessor<ui16, ui16, TestIsSolid> runs(&tree, size, TestIsSolid());
+
+    // Straight down onto the floor
+    vvox::VoxelRay ray = { f32v3(5.5f, 15.5f, 5.5f), f32v3(0.0f, -1.0f, 0.0f), 100.0f };
+    vvox::VoxelRaycastResult result = vvox::raycast(flat, size, ray);
+    test_assert(result.hit && result.voxel == ui32v3(5, 3, 5) && result.face == vvox::Cardinal::Y_POS);
+    test_assert(std::abs(result.distance - 11.5f) < 1e-4f);
+
+    // Straight up, out of the chunk, and short of the floor
+    ray.direction = f32v3(0.0f, 1.0f, 0.0f);
+    test_assert(!vvox::raycast(flat, size, ray).hit && !vvox::raycast(runs, size, ray).hit);
+    ray.direction = f32v3(0.0f, -1.0f, 0.0f);
+    ray.maxDistance = 11.0f;
+    test_assert(!vvox::raycast(flat, size, ray).hit && !vvox::raycast(runs, size, ray).hit);
+
+    // Along x from outside the chunk, hitting both ends of the wall run
+    ray = { f32v3(-3.0f, 4.5f, 8.5f), f32v3(1.0f, 0.0f, 0.0f), 100.0f };
+    result = vvox::raycast(runs, size, ray);
+    test_assert(result.hit && result.voxel == ui32v3(20, 4, 8) && result.face == vvox::Cardinal::X_NEG);
+    test_assert(std::abs(result.distance - 23.0f) < 1e-4f);
+    ray = { f32v3(40.0f, 4.5f, 8.5f), f32v3(-1.0f, 0.0f, 0.0f), 100.0f };
+    result = vvox::raycast(runs, size, ray);
+    test_assert(result.hit && result.voxel == ui32v3(23, 4, 8) && result.face == vvox::Cardinal::X_POS);
+    test_assert(std::abs(result.distance - 16.0f) < 1e-4f);
+
+    // Pointing away from the chunk
+    ray = { f32v3(-3.0f, 4.5f, 8.5f), f32v3(-1.0f, 0.0f, 0.0f), 100.0f };
+    test_assert(!vvox::raycast(flat, size, ray).hit && !vvox::raycast(runs, size, ray).hit);
+
+    // Random rays across the runs agree with sampling, through either accessor
+    std::uniform_real_distribution<f32> unit(-1.0f, 1.0f);
+    for (int i = 0; i < 300; i++) {
+        ray.origin = f32v3((unit(random) * 0.5f + 0.5f) * (size.x + 8) - 4.0f,
+                           (unit(random) * 0.5f + 0.5f) * (size.y + 8) - 4.0f,
+                           (unit(random) * 0.5f + 0.5f) * (size.z + 8) - 4.0f);
+        // Lean towards x so rays cross several runs
+        ray.direction = glm::normalize(f32v3(unit(random) * 3.0f, unit(random), unit(random)));
+        ray.maxDistance = 60.0f;
+        vvox::VoxelRaycastResult brute = bruteRaycast(data, size, ray);
+        test_assert(sameHit(vvox::raycast(flat, size, ray), brute));
+        test_assert(sameHit(vvox::raycast(runs, size, ray), brute));
+    }
+    return true;
 }
\ No newline at end of file
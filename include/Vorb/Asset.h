@@ -31,6 +31,7 @@ namespace vorb {
             nString name;
             volatile bool isLoaded;
             bool shouldFree;
+            size_t memoryCost = 0; ///< Approximate resident size in bytes, set by the builder during creation
         };
     }
 }
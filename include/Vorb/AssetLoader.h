@@ -29,12 +29,19 @@
 #include "Vorb/io/Path.h"
 #include "Vorb/Asset.h"
 
+#include <algorithm>
 #include <memory>
 #include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 
 namespace vorb {
     namespace core {
 
+        /// Specialized per asset type with create(path, asset, rpc) and destroy(asset)
+        ///
+        /// create() must set Asset::memoryCost for the asset to count against the memory budget.
         template<typename T> struct AssetBuilder;
 
         class GLRPC : public RPC {
@@ -54,6 +61,14 @@ namespace vorb {
         };
 
         /// T should derive from vcore::Asset
+        ///
+        /// Residency is optional: with a non-zero memory budget, updateGL() evicts the
+        /// least recently used unpinned assets once the summed Asset::memoryCost of
+        /// loaded assets exceeds the budget. Evicted assets keep their object (so handed
+        /// out pointers stay valid) but are destroyed and flagged as not loaded. The next
+        /// get() or load() of an evicted asset queues it, and the following updateGL()
+        /// reloads it through the normal async path. Assets whose builder leaves memoryCost
+        /// at 0 are never evicted.
         template<typename T>
         class AssetLoader {
             friend struct AssetBuilder < T > ;
@@ -65,12 +80,52 @@ namespace vorb {
             void free(const nString& name);
             void freeAll();
 
+            /// Sets the memory budget for loaded assets
+            /// @param bytes: Maximum summed memoryCost of loaded assets, 0 disables eviction
+            void setMemoryBudget(size_t bytes);
+            size_t getMemoryBudget() const;
+            /// @return The summed memoryCost of all currently loaded assets
+            size_t getResidentMemory() const;
+
+            /// Prevents an asset from being evicted
+            /// @param name: Name of the asset
+            void pin(const nString& name);
+            /// Allows a pinned asset to be evicted again
+            /// @param name: Name of the asset
+            void unpin(const nString& name);
+
+            /// Processes GL requests, then evicts assets if over budget and advances the frame
             void updateGL();
         private:
-            std::mutex m_mutex;
+            /// Residency bookkeeping for a single asset
+            struct Residency {
+                vpath path; ///< Path used to (re)load the asset
+                ui64 lastUsedFrame = 0; ///< Last frame in which the asset was requested
+                bool isPinned = false; ///< Pinned assets are never evicted
+                bool isEvicted = false; ///< True when the asset was destroyed to honor the budget
+                bool isReloadQueued = false; ///< Evicted but requested again, reloaded by updateGL()
+            };
+
+            /// Marks an asset as used this frame, queueing a reload if it was evicted
+            /// @pre m_mutex is held
+            void touch(T* asset) const;
+            /// Runs the builder for an asset on a detached thread
+            void launchLoad(T* asset, const vpath& path);
+            /// Destroys least recently used assets until the budget is met
+            /// @pre m_mutex is held
+            void evictToBudget();
+            /// Reloads evicted assets that were requested again
+            /// @pre m_mutex is held
+            void reloadQueued();
+
+            mutable std::mutex m_mutex;
             RPCManager m_rpc;
             AssetBuilder<T>* m_context = nullptr;
             std::unordered_map<nString, T*> m_assets;
+            mutable std::unordered_map<nString, Residency> m_residency; ///< Updated by const lookups
+            mutable bool m_hasQueuedReloads = false;
+            size_t m_memoryBudget = 0; ///< 0 means unlimited
+            ui64 m_frame = 0; ///< Incremented by every updateGL()
         };
 
 #define CONTEXTUAL_ASSET_LOADER_HEADER(LOADER_TYPENAME, ASSET_TYPENAME) \
@@ -9,18 +9,32 @@ CALLEE_DELETE T* AssetLoader<T>::load(const nString& name, const vpath& path) {
     {
         std::unique_lock<std::mutex> lock(m_mutex);
         auto kvp = m_assets.find(name);
-        if (kvp != m_assets.end()) return kvp->second;
+        if (kvp != m_assets.end()) {
+            touch(kvp->second);
+            return kvp->second;
+        }
 
         asset = new T;
         m_assets[name] = asset;
         asset->name = name;
         asset->isLoaded = false;
         asset->shouldFree = false;
+
+        Residency& residency = m_residency[name];
+        residency.path = path;
+        residency.lastUsedFrame = m_frame;
     }
 
+    launchLoad(asset, path);
 
+    return asset;
+}
+
+template<typename T>
+void AssetLoader<T>::launchLoad(T* asset, const vpath& path) {
     auto f = [=](AssetLoader<T>* loader, OUT T* asset, vpath path) {
-        // Perform loading logic
+        // Perform loading logic, the builder reports the cost of this load
+        asset->memoryCost = 0;
         (loader->m_context)->create(path, asset, loader->m_rpc);
 
         {
@@ -32,14 +46,13 @@ CALLEE_DELETE T* AssetLoader<T>::load(const nString& name, const vpath& path) {
             // Free if called before loaded
             if (asset->shouldFree) {
                 loader->m_assets.erase(asset->name);
+                loader->m_residency.erase(asset->name);
                 delete asset;
             }
         }
     };
 
     { std::thread(f, this, asset, path).detach(); }
-
-    return asset;
 }
 
 template<typename T>
@@ -49,8 +62,15 @@ void AssetLoader<T>::free(const nString& name) {
     if (kvp == m_assets.end()) return;
 
     T* asset = kvp->second;
-    if (asset->isLoaded) {
+    auto residency = m_residency.find(name);
+    if (residency != m_residency.end() && residency->second.isEvicted) {
+        // Already destroyed by eviction and no load is in flight
+        m_assets.erase(kvp);
+        m_residency.erase(residency);
+        delete asset;
+    } else if (asset->isLoaded) {
         m_assets.erase(kvp);
+        if (residency != m_residency.end()) m_residency.erase(residency);
         m_context->destroy(asset);
         delete asset;
     } else {
@@ -61,21 +81,124 @@ template<typename T>
 void AssetLoader<T>::freeAll() {
     std::unique_lock<std::mutex> lock(m_mutex);
     for (auto kvp : m_assets) {
-        m_context->destroy(kvp.second);
+        auto residency = m_residency.find(kvp.first);
+        if (residency == m_residency.end() || !residency->second.isEvicted) {
+            m_context->destroy(kvp.second);
+        }
         delete kvp.second;
     }
     std::unordered_map<nString, T*>().swap(m_assets);
+    std::unordered_map<nString, Residency>().swap(m_residency);
     // TODO: Make sure this is safe while objects are loading
 }
 
+template<typename T>
+void AssetLoader<T>::setMemoryBudget(size_t bytes) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_memoryBudget = bytes;
+}
+
+template<typename T>
+size_t AssetLoader<T>::getMemoryBudget() const {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    return m_memoryBudget;
+}
+
+template<typename T>
+size_t AssetLoader<T>::getResidentMemory() const {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    size_t resident = 0;
+    for (auto& kvp : m_assets) {
+        if (kvp.second->isLoaded) resident += kvp.second->memoryCost;
+    }
+    return resident;
+}
+
+template<typename T>
+void AssetLoader<T>::pin(const nString& name) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    auto residency = m_residency.find(name);
+    if (residency != m_residency.end()) residency->second.isPinned = true;
+}
+template<typename T>
+void AssetLoader<T>::unpin(const nString& name) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    auto residency = m_residency.find(name);
+    if (residency != m_residency.end()) residency->second.isPinned = false;
+}
+
+template<typename T>
+void AssetLoader<T>::touch(T* asset) const {
+    Residency& residency = m_residency[asset->name];
+    residency.lastUsedFrame = m_frame;
+
+    // Bring evicted assets back in on the next update
+    if (residency.isEvicted) {
+        residency.isReloadQueued = true;
+        m_hasQueuedReloads = true;
+    }
+}
+
+template<typename T>
+void AssetLoader<T>::evictToBudget() {
+    size_t resident = 0;
+    std::vector<std::pair<ui64, T*>> candidates;
+    for (auto& kvp : m_assets) {
+        T* asset = kvp.second;
+        if (!asset->isLoaded) continue;
+        resident += asset->memoryCost;
+
+        // Never evict pinned assets or those requested during this frame
+        const Residency& residency = m_residency[kvp.first];
+        if (asset->memoryCost && !residency.isPinned && residency.lastUsedFrame < m_frame) {
+            candidates.emplace_back(residency.lastUsedFrame, asset);
+        }
+    }
+    if (resident <= m_memoryBudget) return;
+
+    std::sort(candidates.begin(), candidates.end(), [](const std::pair<ui64, T*>& a, const std::pair<ui64, T*>& b) {
+        return a.first < b.first;
+    });
+
+    for (auto& candidate : candidates) {
+        if (resident <= m_memoryBudget) break;
+
+        T* asset = candidate.second;
+        m_context->destroy(asset);
+        asset->isLoaded = false;
+        resident -= asset->memoryCost;
+        m_residency[asset->name].isEvicted = true;
+    }
+}
+
+template<typename T>
+void AssetLoader<T>::reloadQueued() {
+    m_hasQueuedReloads = false;
+    for (auto& kvp : m_residency) {
+        Residency& residency = kvp.second;
+        if (!residency.isReloadQueued) continue;
+        residency.isReloadQueued = false;
+        residency.isEvicted = false;
+        launchLoad(m_assets[kvp.first], residency.path);
+    }
+}
+
 template<typename T>
 void AssetLoader<T>::updateGL() {
     m_rpc.processRequests(1);
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (m_hasQueuedReloads) reloadQueued();
+    if (m_memoryBudget) evictToBudget();
+    m_frame++;
 }
 
 template<typename T>
 CALLEE_DELETE T* AssetLoader<T>::get(const nString& name) const {
     std::unique_lock<std::mutex> lock(m_mutex);
     auto kvp = m_assets.find(name);
-    return kvp == m_assets.end() ? nullptr : kvp->second;
+    if (kvp == m_assets.end()) return nullptr;
+
+    touch(kvp->second);
+    return kvp->second;
 }
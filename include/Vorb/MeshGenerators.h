@@ -19,6 +19,7 @@
 //! @endcond
 
 #ifndef VORB_USING_PCH
+#include <memory>
 #include <vector>
 
 #include "Vorb/types.h"
@@ -27,11 +28,27 @@
 namespace vorb {
     namespace core {
         namespace mesh {
+            /// Index and position buffers of an icosphere
+            struct IcosphereMesh {
+            public:
+                std::vector<ui32> indices; ///< Counter-clockwise triangles
+                std::vector<f32v3> positions; ///< Unit length positions
+            };
+
             /// Generates position and index buffer for an icosphere mesh
             /// @param lod: Number of subdivisions. 0 For lowest quality
             /// @param indices: Resulting index buffer
             /// @param positions: Resulting position buffer
             extern void generateIcosphereMesh(int lod, std::vector<ui32>& indices, std::vector<f32v3>& positions);
+            /// Gets an icosphere mesh from a thread-safe cache, generating it and any coarser levels if needed
+            ///
+            /// Each level subdivides the one before it, so its positions start with every position
+            /// of the coarser levels. High levels subdivide in parallel.
+            /// @param lod: Number of subdivisions. 0 For lowest quality
+            /// @return Cached mesh, shared so it outlives clearIcosphereCache
+            extern std::shared_ptr<const IcosphereMesh> getIcosphereMesh(int lod);
+            /// Frees all cached icosphere meshes that are not held elsewhere
+            extern void clearIcosphereCache();
         }
     }
 }
@@ -25,6 +25,12 @@
 #include "../Event.hpp"
 #include "../io/Path.h"
 
+namespace vorb {
+    namespace io {
+        class DerivedDataCache;
+    }
+}
+
 namespace vorb {
     namespace graphics {
         enum class ImageIOFormat {
@@ -80,7 +86,17 @@ namespace vorb {
             bool save(const vio::Path& path, const void* inData, const ui32& w,
                       const ui32& h, const ImageIOFormat& format);
 
+            /// Check a cache for decoded pixels before decoding, and store new decodes in it
+            /// @param cache: Cache to use, null to always decode
+            void setCache(vio::DerivedDataCache* cache) {
+                m_cache = cache;
+            }
+
             Event<nString> onError;
+        private:
+            BitmapResource decode(const vio::Path& path, const ImageIOFormat& format, bool flipV);
+
+            vio::DerivedDataCache* m_cache = nullptr;
         };
 
         /// Destroys the resource in the destructor
@@ -0,0 +1,127 @@
+//
+// AsyncFileReader.h
+// Vorb Engine
+//
+// Created by the Vorb team on 18 Oct 2026
+// Copyright 2014 Regrowth Studios
+// MIT License
+//
+
+/*! \file AsyncFileReader.h
+ * @brief Reads batches of files concurrently on worker threads.
+ */
+
+#pragma once
+
+#ifndef Vorb_AsyncFileReader_h__
+//! @cond DOXY_SHOW_HEADER_GUARDS
+#define Vorb_AsyncFileReader_h__
+//! @endcond
+
+#ifndef VORB_USING_PCH
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "../types.h"
+#endif // !VORB_USING_PCH
+
+#include "../ThreadPool.h"
+#include "IOManager.h"
+#include "Path.h"
+
+namespace vorb {
+    namespace io {
+        /// Contents of a file read asynchronously
+        struct AsyncReadResult {
+        public:
+            Path path; ///< Path as it was requested
+            bool success = false; ///< True if the file was found and read
+            std::vector<ui8> data; ///< Contents of the file
+        };
+
+        /// Reads files on a fixed number of worker threads
+        ///
+        /// Each worker performs one blocking read at a time, so the number of workers bounds
+        /// the number of reads the disk sees at once. Paths are resolved through the
+        /// IOManager passed with the batch.
+        class AsyncFileReader {
+        public:
+            AsyncFileReader() {};
+            ~AsyncFileReader() { dispose(); }
+
+            /// Starts the worker threads
+            /// @param workers: Number of concurrent reads
+            void init(ui32 workers);
+            /// Waits for queued reads and stops the workers
+            void dispose();
+
+            /// Reads a batch of files, calling back as each one finishes
+            ///
+            /// Callbacks may run concurrently on different workers and in any order.
+            /// @param ioManager: Manager used to resolve the paths
+            /// @param paths: Files to read
+            /// @param callback: Called once per path
+            void read(const IOManager& ioManager, const std::vector<Path>& paths, AsyncReadCallback callback);
+            /// Reads a batch of files
+            /// @param ioManager: Manager used to resolve the paths
+            /// @param paths: Files to read
+            /// @return Results in the order of paths, ready once every file is read
+            std::future<std::vector<AsyncReadResult> > read(const IOManager& ioManager, const std::vector<Path>& paths);
+
+            /// Blocks until every queued read has finished
+            void wait();
+
+            /// @return A reader shared by the process, started on first use
+            static AsyncFileReader& getShared();
+
+            /// Getters
+            bool isInitialized() const { return m_isInitialized; }
+            size_t getPending() const;
+        private:
+            VORB_NON_COPYABLE(AsyncFileReader);
+            struct Batch;
+
+            /// Per-thread state of a worker
+            struct WorkerData {
+            public:
+                volatile bool stop = false; ///< Required by the thread pool
+            };
+
+            /// Reads a single file of a batch and deletes itself afterwards
+            class ReadTask : public vcore::IThreadPoolTask<WorkerData> {
+            public:
+                ReadTask(AsyncFileReader* reader, const std::shared_ptr<Batch>& batch, size_t index) :
+                    m_reader(reader),
+                    m_batch(batch),
+                    m_index(index) {
+                    // Empty
+                }
+
+                virtual void execute(WorkerData* workerData) override;
+                virtual void cleanup() override {
+                    delete this;
+                }
+            private:
+                AsyncFileReader* m_reader;
+                std::shared_ptr<Batch> m_batch;
+                size_t m_index;
+            };
+
+            /// Queues a task for every path of a batch
+            void enqueue(const std::shared_ptr<Batch>& batch);
+
+            vcore::ThreadPool<WorkerData> m_pool; ///< Worker threads
+            mutable std::mutex m_lock; ///< Guards m_pending
+            std::condition_variable m_cond; ///< Signals finished reads
+            size_t m_pending = 0; ///< Queued reads that have not finished
+            bool m_isInitialized = false;
+        };
+    }
+}
+namespace vio = vorb::io;
+
+#endif // !Vorb_AsyncFileReader_h__
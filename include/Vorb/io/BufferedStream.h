@@ -0,0 +1,164 @@
+//
+// BufferedStream.h
+// Vorb Engine
+//
+// Created by the Vorb team on 18 Oct 2026
+// Copyright 2014 Regrowth Studios
+// MIT License
+//
+
+/*! \file BufferedStream.h
+ * @brief Buffered cursors for parsing and writing large files incrementally.
+ */
+
+#pragma once
+
+#ifndef Vorb_BufferedStream_h__
+//! @cond DOXY_SHOW_HEADER_GUARDS
+#define Vorb_BufferedStream_h__
+//! @endcond
+
+#ifndef VORB_USING_PCH
+#include "../types.h"
+#endif // !VORB_USING_PCH
+
+#include "FileStream.h"
+
+namespace vorb {
+    namespace io {
+        /// Reads a stream through a buffer owned by the caller, so memory stays bounded for any file size
+        ///
+        /// Bytes are looked at in place with peek and released with consume. Unconsumed bytes are
+        /// moved to the front of the buffer when more must be read. Refills end on a multiple of
+        /// BLOCK_SIZE in the file, and copies larger than the buffer skip it entirely.
+        class StreamReader {
+        public:
+            static const size_t BLOCK_SIZE = 4096; ///< Granularity of reads from the stream
+
+            StreamReader() {}
+            /// Read a file stream
+            /// @param stream: Opened stream, read from its current offset
+            /// @param buffer: Storage for buffered bytes, must outlive the reader
+            /// @param capacity: Size of the buffer, the largest span peek can return
+            StreamReader(const FileStream& stream, void* buffer, size_t capacity) {
+                init(stream, buffer, capacity);
+            }
+            /// Read memory in place, such as a MappedFile, without any copies
+            /// @param data: Bytes to read, must outlive the reader
+            /// @param size: Number of bytes
+            StreamReader(const void* data, size_t size) {
+                init(data, size);
+            }
+
+            void init(const FileStream& stream, void* buffer, size_t capacity);
+            void init(const void* data, size_t size);
+
+            /// Look at the next bytes without consuming them
+            /// @param size: Number of bytes needed, at most the capacity
+            /// @return Start of the bytes, null if the stream ends first
+            const ui8* peek(size_t size);
+            /// Look at whatever is buffered, reading more only if nothing is
+            /// @param size: Receives the number of bytes available, 0 at the end of the stream
+            /// @return Start of the bytes
+            const ui8* peekAvailable(OUT size_t& size);
+            /// Look at the bytes up to and including a delimiter, such as a line
+            /// @param delimiter: Byte that ends the span
+            /// @param size: Receives the length of the span, including the delimiter if it was found
+            /// @return Start of the span, running to the end of the stream if there is no delimiter, or
+            /// null if the span doesn't fit in the buffer or the stream has ended
+            const ui8* peekUntil(ui8 delimiter, OUT size_t& size);
+            /// Release bytes that were peeked
+            /// @pre size must not exceed the bytes peeked
+            void consume(size_t size) {
+                m_begin += size;
+                m_consumed += size;
+            }
+
+            /// Copy the next bytes out of the stream
+            /// @param data: Destination
+            /// @param size: Number of bytes wanted
+            /// @return Number of bytes copied, less than size only at the end of the stream
+            size_t read(OUT void* data, size_t size);
+            /// Skip the next bytes
+            /// @return Number of bytes skipped
+            size_t skip(size_t size);
+
+            /// @return True once every byte has been consumed
+            bool isEOF() {
+                return m_begin == m_end && !fill(1);
+            }
+            /// @return Number of bytes consumed since init
+            ui64 getOffset() const { return m_consumed; }
+        private:
+            VORB_NON_COPYABLE(StreamReader);
+
+            /// Make at least size bytes available, compacting the buffer if needed
+            /// @return False if the stream ended first
+            bool fill(size_t size);
+
+            FileStream m_stream;
+            ui8* m_buffer = nullptr; ///< Caller storage, null when reading memory
+            const ui8* m_data = nullptr; ///< Start of the buffer or the memory
+            size_t m_capacity = 0;
+            size_t m_begin = 0; ///< First unconsumed byte
+            size_t m_end = 0; ///< End of the valid bytes
+            ui64 m_consumed = 0;
+            ui64 m_streamOffset = 0; ///< Bytes read from the stream since init
+            bool m_streamEnded = true;
+        };
+
+        /// Writes a stream through a buffer owned by the caller
+        ///
+        /// Space is claimed with reserve, filled in place and published with commit. Writes larger
+        /// than the buffer go straight to the stream. The buffer is flushed on destruction.
+        class StreamWriter {
+        public:
+            StreamWriter() {}
+            /// Write a file stream
+            /// @param stream: Opened stream, written at its current offset
+            /// @param buffer: Storage for pending bytes, must outlive the writer
+            /// @param capacity: Size of the buffer, the largest span reserve can return
+            StreamWriter(const FileStream& stream, void* buffer, size_t capacity) {
+                init(stream, buffer, capacity);
+            }
+            ~StreamWriter() { flush(); }
+
+            void init(const FileStream& stream, void* buffer, size_t capacity);
+
+            /// Claim space to write into, flushing the buffer to make room
+            /// @param size: Number of bytes needed, at most the capacity
+            /// @return Start of the space, null if it is too large or the stream failed
+            ui8* reserve(size_t size);
+            /// Publish bytes written to reserved space
+            /// @pre size must not exceed the bytes reserved
+            void commit(size_t size) {
+                m_end += size;
+                m_committed += size;
+            }
+
+            /// Copy bytes into the stream
+            /// @return False if the stream failed
+            bool write(const void* data, size_t size);
+            /// Write buffered bytes to the stream
+            /// @return False if the stream failed
+            bool flush();
+
+            /// @return True after any failed write
+            bool hasFailed() const { return m_failed; }
+            /// @return Number of bytes committed since init
+            ui64 getOffset() const { return m_committed; }
+        private:
+            VORB_NON_COPYABLE(StreamWriter);
+
+            FileStream m_stream;
+            ui8* m_buffer = nullptr;
+            size_t m_capacity = 0;
+            size_t m_end = 0; ///< Bytes waiting to be written
+            ui64 m_committed = 0;
+            bool m_failed = false;
+        };
+    }
+}
+namespace vio = vorb::io;
+
+#endif // !Vorb_BufferedStream_h__
@@ -0,0 +1,56 @@
+//
+// Compression.h
+// Vorb Engine
+//
+// Created by the Vorb team on 18 Oct 2026
+// Copyright 2014 Regrowth Studios
+// MIT License
+//
+
+/*! \file Compression.h
+ * @brief Fast LZ77 block compression in the LZ4 block format.
+ */
+
+#pragma once
+
+#ifndef Vorb_Compression_h__
+//! @cond DOXY_SHOW_HEADER_GUARDS
+#define Vorb_Compression_h__
+//! @endcond
+
+#ifndef VORB_USING_PCH
+#include "../types.h"
+#endif // !VORB_USING_PCH
+
+namespace vorb {
+    namespace io {
+        /// Compression favours speed over ratio and suits data with long repeats, such as
+        /// serialized voxel runs. Blocks carry no header, so callers store the uncompressed
+        /// size themselves.
+
+        /// @param size: Number of bytes to compress
+        /// @return Largest number of bytes compressBlock may write for size input bytes
+        size_t compressBound(size_t size);
+
+        /// Compress a block of bytes
+        /// @param src: Bytes to compress
+        /// @param size: Number of bytes in src
+        /// @param dst: Receives the compressed bytes
+        /// @param capacity: Size of dst, compressBound(size) always suffices
+        /// @return Number of bytes written to dst, 0 if it did not fit
+        size_t compressBlock(const ui8* src, size_t size, OUT ui8* dst, size_t capacity);
+
+        /// Decompress a block written by compressBlock
+        ///
+        /// Malformed input is detected and never causes reads or writes outside the buffers.
+        /// @param src: Compressed bytes
+        /// @param size: Number of bytes in src
+        /// @param dst: Receives the decompressed bytes
+        /// @param capacity: Size of dst
+        /// @return Number of bytes written to dst, 0 on malformed input or if it did not fit
+        size_t decompressBlock(const ui8* src, size_t size, OUT ui8* dst, size_t capacity);
+    }
+}
+namespace vio = vorb::io;
+
+#endif // !Vorb_Compression_h__
@@ -0,0 +1,127 @@
+//
+// DerivedDataCache.h
+// Vorb Engine
+//
+// Created by the Vorb team on 18 Oct 2026
+// Copyright 2014 Regrowth Studios
+// MIT License
+//
+
+/*! \file DerivedDataCache.h
+ * @brief On-disk cache of data processed from source files.
+ */
+
+#pragma once
+
+#ifndef Vorb_DerivedDataCache_h__
+//! @cond DOXY_SHOW_HEADER_GUARDS
+#define Vorb_DerivedDataCache_h__
+//! @endcond
+
+#ifndef VORB_USING_PCH
+#include <vector>
+
+#include "../types.h"
+#endif // !VORB_USING_PCH
+
+#include "Hash.h"
+#include "Path.h"
+
+namespace vorb {
+    namespace io {
+        /// Identifies the result of processing a source with a processor and its settings
+        struct DerivedDataKey {
+        public:
+            DerivedDataKey() {}
+            /// @param sourceHash: Hash of the source contents
+            /// @param processor: Name of the processor
+            /// @param processorVersion: Bump whenever the processor's output changes
+            /// @param settingsHash: Hash of the settings that affect the output
+            DerivedDataKey(ui64 sourceHash, const nString& processor, ui32 processorVersion, ui64 settingsHash = 0) :
+                sourceHash(sourceHash),
+                processorHash(hash64(processor)),
+                settingsHash(settingsHash),
+                processorVersion(processorVersion) {
+                // Empty
+            }
+
+            /// @return Hash of every part of the key
+            ui64 combine() const;
+
+            bool operator==(const DerivedDataKey& other) const {
+                return sourceHash == other.sourceHash && processorHash == other.processorHash &&
+                    settingsHash == other.settingsHash && processorVersion == other.processorVersion;
+            }
+
+            ui64 sourceHash = 0;
+            ui64 processorHash = 0; ///< Hash of the processor name
+            ui64 settingsHash = 0;
+            ui32 processorVersion = 0;
+        };
+
+        /// Stores processed data keyed on the content that produced it, so it survives restarts
+        ///
+        /// Each entry is one file in the cache directory, compressed when that pays off and
+        /// checked against its key and a hash of its data when loaded. Entries are written to a
+        /// temporary file and renamed, so a crash never leaves a partial entry behind. Once
+        /// initialized, the cache may be used from any thread.
+        class DerivedDataCache {
+        public:
+            DerivedDataCache() {}
+
+            /// Use a directory for the cache, creating it if needed
+            /// @param directory: Where entries are stored
+            /// @return True if the directory exists
+            bool init(const Path& directory);
+
+            /// Build the key for processing a source file, hashing its contents
+            /// @param source: File the data is produced from
+            /// @param processor: Name of the processor
+            /// @param processorVersion: Bump whenever the processor's output changes
+            /// @param settingsHash: Hash of the settings that affect the output
+            /// @param key: Receives the key
+            /// @return True if the source could be read
+            static bool makeKey(const Path& source, const nString& processor, ui32 processorVersion, ui64 settingsHash, OUT DerivedDataKey& key);
+
+            /// Load an entry
+            /// @param key: Key the entry was stored under
+            /// @param data: Receives the data
+            /// @return True if a valid entry was found
+            bool load(const DerivedDataKey& key, OUT std::vector<ui8>& data) const;
+            /// Store an entry, replacing any previous one
+            /// @param key: Key to store the entry under
+            /// @param data: Bytes to store
+            /// @param size: Number of bytes
+            /// @return True if the entry was written
+            bool store(const DerivedDataKey& key, const void* data, size_t size) const;
+            /// Remove an entry
+            /// @return True if an entry was removed
+            bool remove(const DerivedDataKey& key) const;
+
+            /// Load an entry, or produce and store it if there is none
+            /// @param key: Key of the entry
+            /// @param data: Receives the data
+            /// @param process: Callable as bool(OUT std::vector<ui8>& data), producing the data
+            /// @return True if the data was loaded or produced
+            template<typename F>
+            bool loadOrProcess(const DerivedDataKey& key, OUT std::vector<ui8>& data, F process) const {
+                if (load(key, data)) return true;
+                data.clear();
+                if (!process(data)) return false;
+                store(key, data.data(), data.size());
+                return true;
+            }
+
+            /// Getters
+            const Path& getDirectory() const { return m_directory; }
+        private:
+            /// @return Path of the file holding an entry
+            nString getEntryPath(const DerivedDataKey& key) const;
+
+            Path m_directory;
+        };
+    }
+}
+namespace vio = vorb::io;
+
+#endif // !Vorb_DerivedDataCache_h__
@@ -19,6 +19,7 @@
 //! @endcond
 
 #ifndef VORB_USING_PCH
+#include <ctime>
 #include <vector>
 
 #include "../types.h"
@@ -32,6 +33,34 @@ namespace vorb {
         typedef std::vector<Path> DirectoryEntries; ///< A list of directory entries
         typedef Delegate<void, Sender, const Path&> DirectoryEntryCallback; ///< Type for a callback function
 
+        /// An entry found by a directory scan
+        struct DirectoryScanEntry {
+        public:
+            Path path; ///< Full path of the entry
+            nString relativePath; ///< Path from the scanned directory, with forward slashes
+            time_t modTime = 0; ///< Last modification time
+            bool isDirectory = false;
+        };
+        typedef std::vector<DirectoryScanEntry> DirectoryScanResults; ///< A list of scanned entries
+
+        /// Controls which entries a directory scan reports
+        ///
+        /// Filters only apply to files. Patterns containing a '/' are matched against the
+        /// relative path, others against the file name. '*' and '?' don't match across
+        /// directories, "**" does.
+        struct DirectoryScanOptions {
+        public:
+            std::vector<nString> patterns; ///< Globs a file must match one of, all files if empty
+            std::vector<nString> extensions; ///< Extensions a file must have one of, case-insensitive, all files if empty
+            bool recursive = true; ///< Descend into subdirectories
+            bool includeDirectories = false; ///< Report directories as well as files
+            ui32 threads = 0; ///< Threads used for the scan, 0 picks one per core up to 8
+
+            /// @param relativePath: Path from the scanned directory, with forward slashes
+            /// @return True if a file passes the filters
+            bool matches(const nString& relativePath) const;
+        };
+
         /// Represents a directory that houses paths
         class Directory {
             friend class Path;
@@ -64,8 +93,22 @@ namespace vorb {
                 forEachEntry(&fDel);
             }
 
+            /// Walk the directory tree on several threads, collecting entries with their modification times
+            ///
+            /// Symbolic links to directories are listed but not followed.
+            /// @param entries: List where entries will be placed, sorted by path
+            /// @param options: Filters and walk settings
+            /// @return Number of added entries
+            size_t scan(OUT DirectoryScanResults& entries, const DirectoryScanOptions& options = DirectoryScanOptions()) const;
+
             /// @return True if this directory contains no elements
             bool isEmpty() const;
+
+            /// Match a string against a glob pattern
+            /// @param pattern: Glob with '*' and '?' stopping at '/', and "**" matching across it
+            /// @param s: String to match
+            /// @return True if the whole string matches
+            static bool matchGlob(const nString& pattern, const nString& s);
         private:
             /// Secret-sauce directory builder
             /// @param p: Path value
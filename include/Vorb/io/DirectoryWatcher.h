@@ -0,0 +1,116 @@
+//
+// DirectoryWatcher.h
+// Vorb Engine
+//
+// Created by the Vorb team on 18 Oct 2026
+// Copyright 2014 Regrowth Studios
+// MIT License
+//
+
+/*! \file DirectoryWatcher.h
+ * @brief Reports files that change within a directory tree.
+ */
+
+#pragma once
+
+#ifndef Vorb_DirectoryWatcher_h__
+//! @cond DOXY_SHOW_HEADER_GUARDS
+#define Vorb_DirectoryWatcher_h__
+//! @endcond
+
+#ifndef VORB_USING_PCH
+#include <chrono>
+#include <map>
+#include <unordered_map>
+
+#include "../types.h"
+#endif // !VORB_USING_PCH
+
+#include "../Event.hpp"
+#include "Directory.h"
+
+namespace vorb {
+    namespace io {
+        /// Kinds of file changes
+        enum class FileChangeType {
+            ADDED,
+            MODIFIED,
+            REMOVED
+        };
+
+        /// A file that changed within a watched directory
+        struct FileChange {
+        public:
+            Path path; ///< Full path of the file
+            nString relativePath; ///< Path from the watched directory, with forward slashes
+            FileChangeType type;
+        };
+
+        /// Watches a directory tree and reports changed files, for hot reloading
+        ///
+        /// On Linux changes come from inotify, elsewhere (or if inotify is unavailable) the tree
+        /// is rescanned at a fixed interval and modification times are compared. Changes are
+        /// collected and coalesced between calls to update, which triggers the events on the
+        /// calling thread. Added and removed files are forgotten by the IOManager path cache.
+        class DirectoryWatcher {
+        public:
+            DirectoryWatcher() :
+                onChange(this) {
+                // Empty
+            }
+            ~DirectoryWatcher() { dispose(); }
+
+            /// Start watching a directory
+            /// @param root: Directory to watch
+            /// @param options: Filters for the files that are reported, and whether subdirectories are watched
+            /// @param forcePolling: Rescan periodically even if the platform can notify changes
+            /// @return True if the directory exists and is being watched
+            bool init(const Path& root, const DirectoryScanOptions& options = DirectoryScanOptions(), bool forcePolling = false);
+            /// Stop watching
+            void dispose();
+
+            /// Collect pending changes and trigger onChange once for each changed file
+            void update();
+
+            /// Set how often the tree is rescanned when polling
+            /// @param seconds: Time between scans
+            void setPollInterval(f64 seconds) {
+                m_pollInterval = std::chrono::duration<f64>(seconds);
+            }
+
+            /// Getters
+            bool isInitialized() const { return m_isInitialized; }
+            /// @return True if changes are found by rescanning
+            bool isPolling() const { return m_isInitialized && m_fd < 0; }
+            const Path& getRoot() const { return m_root; }
+
+            Event<const FileChange&> onChange; ///< Triggered by update for every changed file
+        private:
+            VORB_NON_COPYABLE(DirectoryWatcher);
+
+            /// Scan the tree and queue the differences to the known files
+            void rescan();
+            /// Watch a directory and its subdirectories, queueing their files as added
+            void watchTree(const nString& relativePath);
+            /// Drain the notifications of the kernel
+            void readNotifications();
+            /// Record a change, merging it with one already queued for the file
+            void queueChange(const nString& relativePath, FileChangeType type);
+            /// Queue removal of every known file below a directory
+            void removeTree(const nString& relativePath);
+
+            Path m_root;
+            DirectoryScanOptions m_options;
+            std::map<nString, time_t> m_files; ///< Known files that pass the filters, with their modification times
+            std::map<nString, FileChangeType> m_changes; ///< Changes not reported yet
+            std::unordered_map<int, nString> m_watches; ///< Relative path of each watched directory
+            int m_fd = -1; ///< inotify descriptor, -1 when polling
+            std::chrono::duration<f64> m_pollInterval = std::chrono::duration<f64>(1.0);
+            std::chrono::steady_clock::time_point m_lastPoll;
+            bool m_isInitialized = false;
+        };
+    }
+}
+namespace vio = vorb::io;
+
+#endif // !Vorb_DirectoryWatcher_h__
@@ -27,6 +27,7 @@
 namespace vorb {
     namespace io {
         class FileStream;
+        class MappedFile;
 
         /// Different modes for opening a file
         enum class FileOpenFlags {
@@ -77,6 +78,10 @@ namespace vorb {
             }
 //            /// @return A file checksum
 //            void computeSum(OUT SHA256Sum* sum) const;
+            /// Hash the contents of the file with vio::hash64
+            /// @param hash: Receives the hash
+            /// @return True if the file could be read
+            bool computeHash(OUT ui64& hash) const;
 
             /// @return The size of the file in bytes
             ui64 length() const;
@@ -98,6 +103,9 @@ namespace vorb {
             /// Create the file handle
             /// @return A stream to the file
             FileStream create(const bool& binary = true) const;
+            /// Map the file into memory for reading
+            /// @return A view of the file, not open on failure
+            MappedFile map() const;
         private:
             /// Secret-sauce file builder
             /// @param p: Path value
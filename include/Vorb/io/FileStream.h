@@ -36,6 +36,7 @@ namespace vorb {
         /// Represents an opened file stream
         class FileStream {
             friend class File;
+            friend class PackFile;
         public:
             /// A null stream constructor
             FileStream() : FileStream(File()) {
@@ -133,6 +134,7 @@ namespace vorb {
             class Handle {
                 friend class FileStream;
                 friend class File;
+                friend class PackFile;
             public:
                 /// Closes the stream
                 ~Handle() {
@@ -144,9 +146,11 @@ namespace vorb {
                         fclose(m_file);
                         m_file = nullptr;
                     }
+                    m_owner.reset();
                 }
             private:
                 FILE* m_file = nullptr; ///< File pointed by the handle
+                std::shared_ptr<const void> m_owner; ///< Keeps alive the memory an in-memory file reads
             };
 
             std::shared_ptr<Handle> m_handle; ///< Ref-counted file handle
@@ -0,0 +1,44 @@
+//
+// Hash.h
+// Vorb Engine
+//
+// Created by the Vorb team on 18 Oct 2026
+// Copyright 2014 Regrowth Studios
+// MIT License
+//
+
+/*! \file Hash.h
+ * @brief Fast non-cryptographic hashing of byte buffers.
+ */
+
+#pragma once
+
+#ifndef Vorb_Hash_h__
+//! @cond DOXY_SHOW_HEADER_GUARDS
+#define Vorb_Hash_h__
+//! @endcond
+
+#ifndef VORB_USING_PCH
+#include "../types.h"
+#endif // !VORB_USING_PCH
+
+namespace vorb {
+    namespace io {
+        /// Hash a block of bytes with XXH64
+        ///
+        /// Results are identical on every platform, so they may be stored on disk. The hash
+        /// detects changed content, it offers no protection against deliberate collisions.
+        /// @param data: Bytes to hash
+        /// @param size: Number of bytes
+        /// @param seed: Starting value, pass a previous hash to chain several buffers
+        /// @return 64-bit hash
+        ui64 hash64(const void* data, size_t size, ui64 seed = 0);
+        /// Hash the characters of a string
+        inline ui64 hash64(const nString& s, ui64 seed = 0) {
+            return hash64(s.data(), s.size(), seed);
+        }
+    }
+}
+namespace vio = vorb::io;
+
+#endif // !Vorb_Hash_h__
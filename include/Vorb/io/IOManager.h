@@ -19,16 +19,25 @@
 //! @endcond
 
 #ifndef VORB_USING_PCH
+#include <functional>
+#include <future>
+#include <vector>
+
 #include "../types.h"
 #endif // !VORB_USING_PCH
 
 #include "Directory.h"
 #include "File.h"
 #include "FileStream.h"
+#include "MappedFile.h"
 #include "Path.h"
 
 namespace vorb {
     namespace io {
+        struct AsyncReadResult;
+        /// Receives each file of a batch as soon as it is read, on a worker thread
+        typedef std::function<void(AsyncReadResult& result)> AsyncReadCallback;
+
         /*! @brief The directory types through which an IOManager searches.
          */
         enum class IOManagerDirectory {
@@ -85,6 +94,27 @@ namespace vorb {
              */
             static void setExecutableDirectory(const Path& s);
 
+            /*! @brief Forget all cached path resolutions.
+             */
+            static void invalidatePathCache();
+            /*! @brief Forget the cached resolutions of a path in every search directory.
+             * 
+             * @param path: The path as it was passed to resolvePath, or the absolute path of a
+             * file, which forgets every relative path that may resolve to it.
+             */
+            static void invalidatePathCache(const Path& path);
+
+            /*! @brief Choose whether this manager caches paths that were not found.
+             * 
+             * Off by default, since files created outside of a manager would keep being reported
+             * missing until the cache is invalidated.
+             * 
+             * @param cacheMisses: True to remember failed resolutions.
+             */
+            void setCacheMisses(bool cacheMisses) {
+                m_cacheMisses = cacheMisses;
+            }
+
             /*! @return The search directory used by this manager.
              */
             const Path& getSearchDirectory() const {
@@ -113,6 +143,13 @@ namespace vorb {
              * If a path is already absolute, this method will not attempt to 
              * go through the list of directories and test path combinations.
              * 
+             * Resolved paths, and failures if setCacheMisses is enabled, are kept in a cache
+             * shared by all managers, so repeated lookups skip the search. A cached path is
+             * checked again on every lookup and forgotten if it no longer exists as the same kind
+             * of entry. Paths created through a manager and files reported by a DirectoryWatcher
+             * invalidate the cache, otherwise call invalidatePathCache after creating a file that
+             * should shadow one found later in the search.
+             * 
              * @param path: The path to search.
              * @param resultAbsolutePath: The resulting absolute path will be stored here.
              * @return True if the path exists and was resolved properly in this environment.
@@ -132,6 +169,27 @@ namespace vorb {
              */
             bool assurePath(const Path& path, OUT Path& resultAbsolutePath, IOManagerDirectory creationDirectory, bool isFile, OPT bool* wasExisting = nullptr) const;
 
+            /*! @brief Serve files from a pack before the file system.
+             * 
+             * Relative paths that a mounted pack contains are read from the pack by openFile
+             * (read-only), readFileToString, readFileToData, mapFile and fileExists, for every
+             * manager. A path is looked up within a relative search directory first, then as
+             * given. Packs mounted later take precedence.
+             * 
+             * @param path: The path to the pack.
+             * @return True if the pack was found and opened.
+             */
+            bool mountPack(const Path& path) const;
+            /*! @brief Stop serving files from a pack.
+             * 
+             * @param path: The path the pack was mounted with.
+             * @return True if the pack was mounted.
+             */
+            bool unmountPack(const Path& path) const;
+            /*! @brief Stop serving files from all packs.
+             */
+            static void unmountAllPacks();
+
             // Open A File Using STD Flags ("r", "w", "b", etc.) 
             // Returns NULL If It Can't Be Found
             FileStream openFile(const Path& path, const FileOpenFlags& flags) const;
@@ -141,6 +199,23 @@ namespace vorb {
             bool readFileToString(const Path& path, OUT nString& data) const;
             CALLER_DELETE cString readFileToString(const Path& path) const;
             bool readFileToData(const Path& path, OUT std::vector<ui8>& data) const;
+            /// Read many files concurrently on the shared AsyncFileReader
+            /// @param paths: The paths to the files
+            /// @param callback: Called on a worker thread as each file is read
+            void readFilesAsync(const std::vector<Path>& paths, AsyncReadCallback callback) const;
+            /// Read many files concurrently on the shared AsyncFileReader
+            /// @param paths: The paths to the files
+            /// @return The files in the order of paths, ready once all are read. AsyncReadResult is
+            /// defined in AsyncFileReader.h
+            std::future<std::vector<AsyncReadResult> > readFilesAsync(const std::vector<Path>& paths) const;
+            /// Map a file into memory for reading, without copying it
+            ///
+            /// Files stored uncompressed in a mounted pack are mapped from the pack, compressed
+            /// ones can't be mapped and must be read instead.
+            /// @param path: The path to the file
+            /// @param file: Receives the view of the file
+            /// @return true if the file was found and mapped
+            bool mapFile(const Path& path, OUT MappedFile& file) const;
 
             /// Writes a string to a file. Creates file if it doesn't exist
             /// @param path: The path to the file
@@ -162,10 +237,18 @@ namespace vorb {
             /// @return true if directory exists
             bool directoryExists(const Path& path) const;
         private:
+            /*! @brief Resolve a path through the cache, also reporting whether it is a file.
+             */
+            bool resolveCachedPath(const Path& path, OUT Path& resultAbsolutePath, OUT bool& isFile) const;
+            /*! @brief Resolve a path by testing each directory in turn, without the cache.
+             */
+            bool resolvePathUncached(const Path& path, OUT Path& resultAbsolutePath) const;
+
             static Path m_pathCWD; ///< The global current working directory.
             static Path m_pathExec; ///< The global executable directory.
 
             Path m_pathSearch; ///< The first path used in the searching process.
+            bool m_cacheMisses = false; ///< True if failed resolutions are cached.
         };
     }
 }
@@ -0,0 +1,81 @@
+//
+// MappedFile.h
+// Vorb Engine
+//
+// Created by the Vorb team on 18 Oct 2026
+// Copyright 2014 Regrowth Studios
+// MIT License
+//
+
+/*! \file MappedFile.h
+ * @brief A read-only memory-mapped view of a file.
+ */
+
+#pragma once
+
+#ifndef Vorb_MappedFile_h__
+//! @cond DOXY_SHOW_HEADER_GUARDS
+#define Vorb_MappedFile_h__
+//! @endcond
+
+#ifndef VORB_USING_PCH
+#include "../types.h"
+#endif // !VORB_USING_PCH
+
+#include "Path.h"
+
+namespace vorb {
+    namespace io {
+        /// A read-only view of a whole file, unmapped on destruction
+        ///
+        /// Pages are loaded on first access, so parsing straight from the view avoids copying
+        /// the file into heap memory. The view is not null-terminated. Writes to the file by
+        /// other handles may or may not become visible, and truncating the file while it is
+        /// mapped is undefined.
+        class MappedFile {
+        public:
+            MappedFile() {}
+            ~MappedFile() { close(); }
+            MappedFile(MappedFile&& other);
+            MappedFile& operator=(MappedFile&& other);
+            MappedFile(const MappedFile&) = delete;
+            MappedFile& operator=(const MappedFile&) = delete;
+
+            /// Map a file, closing any previous mapping
+            /// @param path: Path of the file
+            /// @return True if the file was mapped
+            bool open(const Path& path);
+            /// Map part of a file, closing any previous mapping
+            ///
+            /// The range is mapped from the page it starts on, so offsets that are a multiple
+            /// of the page size waste no address space.
+            /// @param path: Path of the file
+            /// @param offset: Byte offset of the range
+            /// @param size: Number of bytes in the range, which must lie within the file
+            /// @return True if the range was mapped
+            bool open(const Path& path, ui64 offset, size_t size);
+            void close();
+
+            /// @return True if a file is mapped, which may be empty
+            bool isOpen() const { return m_isOpen; }
+            /// @return Start of the file's bytes, null for an empty file
+            const ui8* getData() const { return m_data; }
+            /// @return Size of the file or range in bytes
+            const size_t& getSize() const { return m_size; }
+            const ui8* begin() const { return m_data; }
+            const ui8* end() const { return m_data + m_size; }
+        private:
+            /// Map a range of a file, or from offset to the end if toEnd is set
+            bool map(const Path& path, ui64 offset, size_t size, bool toEnd);
+
+            const ui8* m_data = nullptr; ///< Mapped bytes
+            size_t m_size = 0; ///< Number of mapped bytes
+            size_t m_viewOffset = 0; ///< Bytes mapped before m_data to start the view on a page
+            bool m_isOpen = false;
+            void* m_mappingHandle = nullptr; ///< Windows file mapping object
+        };
+    }
+}
+namespace vio = vorb::io;
+
+#endif // !Vorb_MappedFile_h__
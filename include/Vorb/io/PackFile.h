@@ -0,0 +1,180 @@
+//
+// PackFile.h
+// Vorb Engine
+//
+// Created by the Vorb team on 18 Oct 2026
+// Copyright 2014 Regrowth Studios
+// MIT License
+//
+
+/*! \file PackFile.h
+ * @brief Indexed archives of many files, read through a memory mapping.
+ */
+
+#pragma once
+
+#ifndef Vorb_PackFile_h__
+//! @cond DOXY_SHOW_HEADER_GUARDS
+#define Vorb_PackFile_h__
+//! @endcond
+
+#ifndef VORB_USING_PCH
+#include <cstdio>
+#include <memory>
+#include <unordered_set>
+#include <vector>
+
+#include "../types.h"
+#endif // !VORB_USING_PCH
+
+#include "FileStream.h"
+#include "MappedFile.h"
+#include "Path.h"
+
+namespace vorb {
+    namespace io {
+        /// Index entry of a file within a pack
+        struct PackEntry {
+        public:
+            ui64 hash; ///< Hash of the normalized name
+            ui64 offset; ///< Page-aligned byte offset of the stored data
+            ui64 storedSize; ///< Bytes stored in the pack
+            ui64 size; ///< Bytes of the original file, equal to storedSize unless compressed
+            ui32 nameOffset; ///< Offset of the name within the name block
+            ui32 nameLength; ///< Length of the name
+            ui32 flags; ///< PackEntry::COMPRESSED if the data is compressed
+            ui32 reserved;
+
+            static const ui32 COMPRESSED = 0x01;
+        };
+
+        /// Shared layout constants of pack files
+        ///
+        /// A pack holds a header, each file's data starting on its own page, and at the end
+        /// an index of entries, a hash table of entry indices and a block of names.
+        class PackFormat {
+        public:
+            static const ui32 MAGIC = 0x4B415056; ///< "VPAK"
+            static const ui32 VERSION = 1;
+            static const ui64 PAGE_SIZE = 4096; ///< Alignment of file data
+
+            struct Header {
+            public:
+                ui32 magic;
+                ui32 version;
+                ui32 entryCount;
+                ui32 tableSize; ///< Slots in the hash table, a power of two
+                ui64 indexOffset; ///< Offset of the entries, followed by the table and names
+                ui64 namesSize; ///< Bytes in the name block
+            };
+
+            /// Convert a path to the form names are stored in, with forward slashes and no leading "./"
+            static nString normalizeName(const nString& name);
+            /// @return Hash of a normalized name
+            static ui64 hashName(const nString& name);
+        };
+
+        /// A read-only pack of files
+        ///
+        /// Reads are thread-safe. Names are relative paths, and lookups normalize separators.
+        class PackFile {
+        public:
+            PackFile() {}
+            ~PackFile() { close(); }
+            PackFile(const PackFile&) = delete;
+            PackFile& operator=(const PackFile&) = delete;
+
+            /// Map a pack and validate its index
+            /// @param path: Path of the pack
+            /// @return True if the pack was opened
+            bool open(const Path& path);
+            void close();
+
+            /// @return Entry of a file, or null if the pack doesn't contain it
+            const PackEntry* find(const nString& name) const;
+            /// @return True if the pack contains a file
+            bool contains(const nString& name) const {
+                return find(name) != nullptr;
+            }
+            /// Read a file, decompressing it if needed
+            /// @param name: Name of the file
+            /// @param data: Receives the contents
+            /// @return True if the file was found and read
+            bool read(const nString& name, OUT std::vector<ui8>& data) const;
+            /// Read an entry, decompressing it if needed
+            bool read(const PackEntry& entry, OUT ui8* data) const;
+            /// Get the bytes of an uncompressed file without copying them
+            /// @return Start of the data, null if the file is missing or compressed
+            const ui8* view(const nString& name, OUT size_t& size) const;
+            /// Open a read-only stream over a file, copying its contents into a temporary file
+            /// @return A stream, not opened if the file is missing
+            FileStream openStream(const nString& name) const;
+            /// Open a read-only stream over a file of a shared pack
+            ///
+            /// Uncompressed files are streamed straight from the mapping where the platform
+            /// supports it, and the stream keeps the pack alive until it is closed. Other files
+            /// are copied into a temporary file.
+            /// @param pack: Pack holding the entry, it must not be closed while the stream is open
+            /// @param entry: Entry of the pack to open
+            /// @return A stream, not opened on failure
+            static FileStream openStream(const std::shared_ptr<const PackFile>& pack, const PackEntry& entry);
+
+            /// Getters
+            const Path& getPath() const { return m_path; }
+            bool isOpen() const { return m_mapping.isOpen(); }
+            size_t getEntryCount() const { return m_entryCount; }
+            /// @return Name of an entry
+            nString getName(const PackEntry& entry) const;
+        private:
+            /// Copy an entry into a temporary file
+            FileStream openCopiedStream(const PackEntry& entry) const;
+
+            Path m_path;
+            MappedFile m_mapping; ///< View of the whole pack
+            const PackEntry* m_entries = nullptr; ///< Index within the mapping
+            const ui32* m_table = nullptr; ///< Hash table of entry index + 1, 0 for empty slots
+            const char* m_names = nullptr; ///< Name block within the mapping
+            ui32 m_entryCount = 0;
+            ui32 m_tableMask = 0;
+        };
+
+        /// Builds a pack file, streaming file data to disk as it is added
+        class PackWriter {
+        public:
+            PackWriter() {}
+            ~PackWriter();
+            PackWriter(const PackWriter&) = delete;
+            PackWriter& operator=(const PackWriter&) = delete;
+
+            /// Start writing a pack, replacing any existing file
+            /// @return True if the file was created
+            bool open(const Path& path);
+            /// Add a file from memory
+            /// @param name: Relative path the file is looked up by
+            /// @param data: Contents of the file
+            /// @param size: Number of bytes
+            /// @param compress: Compress the data if that makes it smaller
+            /// @return False on a write error or a duplicate name
+            bool add(const nString& name, const void* data, size_t size, bool compress = true);
+            /// Add a file from disk
+            /// @param name: Relative path the file is looked up by
+            /// @param source: File to read
+            /// @param compress: Compress the data if that makes it smaller
+            /// @return False if the source could not be read, on a write error or a duplicate name
+            bool addFile(const nString& name, const Path& source, bool compress = true);
+            /// Write the index and close the pack
+            /// @return True if the pack was completed
+            bool finish();
+        private:
+            FILE* m_file = nullptr;
+            ui64 m_offset = 0; ///< End of the written data
+            std::vector<PackEntry> m_entries;
+            nString m_names; ///< Name block
+            std::unordered_set<nString> m_addedNames; ///< Normalized names, to reject duplicates
+            bool m_failed = false; ///< True after a write error
+        };
+    }
+}
+namespace vio = vorb::io;
+
+#endif // !Vorb_PackFile_h__
@@ -1,6 +1,7 @@
 #if VORB_USE_FILESYSTEM == 1
     #include <filesystem>
     namespace fs = std::filesystem;
+    typedef std::error_code fs_error_code;
 #elif VORB_USE_FILESYSTEM == 2
     #include <experimental/filesystem>
     #ifdef VORB_COMPILER_MSVC
@@ -8,8 +9,10 @@
     #else
         namespace fs = std::experimental::filesystem;
     #endif
+    typedef std::error_code fs_error_code;
 #else
     #include <boost/filesystem.hpp>
     #include <boost/filesystem/operations.hpp>
     namespace fs = boost::filesystem;
+    typedef boost::system::error_code fs_error_code;
 #endif
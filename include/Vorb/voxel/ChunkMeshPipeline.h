@@ -0,0 +1,202 @@
+//
+// ChunkMeshPipeline.h
+// Vorb Engine
+//
+// Created by the Vorb team on 18 Oct 2026
+// Copyright 2014 Regrowth Studios
+// MIT License
+//
+
+/*! \file ChunkMeshPipeline.h
+ * @brief Meshes batches of chunks across a thread pool into packed vertex streams.
+ */
+
+#pragma once
+
+#ifndef Vorb_ChunkMeshPipeline_h__
+//! @cond DOXY_SHOW_HEADER_GUARDS
+#define Vorb_ChunkMeshPipeline_h__
+//! @endcond
+
+#ifndef VORB_USING_PCH
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "../types.h"
+#include "../VorbAssert.hpp"
+#endif // !VORB_USING_PCH
+
+#include "../ThreadPool.h"
+#include "VoxelMeshAlg.h"
+#include "VoxelMesherCulled.h"
+
+namespace vorb {
+    namespace voxel {
+        /// A chunk to be meshed
+        /// @tparam T: Voxel data type
+        /// @tparam Policy: Meshing policy of the pipeline
+        template<typename T, typename Policy>
+        struct ChunkMeshJob {
+        public:
+            /// Produces the quads of a chunk on a worker
+            /// @param view: Chunk to mesh
+            /// @param policy: The worker's copy of the policy
+            /// @param quads: Receives the quads, empty on entry
+            typedef void (*Mesher)(const meshalg::ChunkView<T>& view, Policy& policy, OUT std::vector<meshalg::VoxelQuad>& quads);
+
+            ui64 id; ///< Caller identifier, returned with the result
+            meshalg::ChunkView<T> view; ///< Voxel data, must stay alive until the result is polled
+            Mesher mesher = nullptr; ///< Null meshes with createCulled and the policy's occludes
+        };
+
+        /// Packed mesh data of a chunk, ready for upload
+        /// @tparam V: Vertex type
+        template<typename V>
+        struct ChunkMeshResult {
+        public:
+            ui64 id; ///< Identifier of the job
+            std::vector<V> vertices; ///< Four vertices per quad, indexed by meshalg::SharedQuadIndices
+        };
+
+        /// Meshes chunks on worker threads with per-thread scratch memory
+        ///
+        /// Policy contract (each worker meshes with its own copy of the policy):
+        /// - typedef ... Vertex
+        /// - VoxelFaces occludes(const T& v1, const T& v2, const Axis& axis), for jobs without a mesher
+        /// - void generateQuad(const ChunkView<T>& view, const VoxelQuad& quad, OUT Vertex* vertices)
+        ///
+        /// A job counts as in flight from submission until its result is polled. submit()
+        /// blocks while the limit is reached, so a thread that both submits and polls should
+        /// use trySubmit() instead.
+        /// @tparam T: Voxel data type
+        /// @tparam Policy: Copyable meshing policy
+        template<typename T, typename Policy>
+        class ChunkMeshPipeline {
+        public:
+            typedef typename Policy::Vertex Vertex;
+            typedef ChunkMeshJob<T, Policy> Job;
+            typedef ChunkMeshResult<Vertex> Result;
+
+            ChunkMeshPipeline() {};
+            ~ChunkMeshPipeline();
+
+            /// Starts the worker threads
+            /// @param policy: Prototype policy copied into every worker
+            /// @param workers: Number of worker threads
+            /// @param maxInFlight: Maximum number of submitted jobs whose results have not been polled
+            void init(const Policy& policy, ui32 workers, size_t maxInFlight);
+            /// Waits for queued jobs, stops the workers and drops unpolled results
+            void destroy();
+
+            /// Submits jobs, blocking while the in-flight limit is reached
+            /// @pre init must have been called
+            /// @param jobs: Array of jobs
+            /// @param count: Number of jobs
+            void submit(const Job* jobs, size_t count);
+            /// Submits as many jobs as fit under the in-flight limit
+            /// @param jobs: Array of jobs
+            /// @param count: Number of jobs
+            /// @return Number of jobs accepted, always a prefix of the array
+            size_t trySubmit(const Job* jobs, size_t count);
+
+            /// Takes one finished mesh
+            /// @param result: Receives the mesh
+            /// @return True if a result was available
+            bool poll(OUT Result& result);
+            /// Takes up to maxResults finished meshes
+            /// @param results: Array of at least maxResults elements
+            /// @param maxResults: Capacity of the array
+            /// @return Number of results written
+            size_t poll(OUT Result* results, size_t maxResults);
+
+            /// @return Chunks meshed per second since the last resetStats, counting only busy time
+            f64 getThroughput() const;
+            /// Restarts throughput measurement
+            void resetStats();
+
+            /// Getters
+            size_t getInFlight() const {
+                std::unique_lock<std::mutex> lock(m_lock);
+                return m_inFlight;
+            }
+            const size_t& getMaxInFlight() const { return m_maxInFlight; }
+            ui64 getChunksMeshed() const { return m_chunksMeshed; }
+        private:
+            VORB_NON_COPYABLE(ChunkMeshPipeline);
+            typedef std::chrono::steady_clock Clock;
+
+            /// Per-thread state that lives as long as the worker
+            struct WorkerData {
+            public:
+                volatile bool stop = false; ///< Required by the thread pool
+                std::unique_ptr<Policy> policy; ///< Copy of the prototype policy, created on first use
+                std::vector<meshalg::VoxelQuad> quads; ///< Reused quad scratch
+            };
+
+            /// Forwards mesher callbacks to a worker's policy and scratch
+            class MeshAPI {
+            public:
+                meshalg::VoxelFaces occludes(const T& v1, const T& v2, const Axis& axis) {
+                    return worker->policy->occludes(v1, v2, axis);
+                }
+                void result(const meshalg::VoxelQuad& quad) {
+                    worker->quads.push_back(quad);
+                }
+
+                WorkerData* worker;
+            };
+
+            /// Meshes a single chunk and deletes itself afterwards
+            class MeshTask : public vcore::IThreadPoolTask<WorkerData> {
+            public:
+                MeshTask(ChunkMeshPipeline* pipeline, const Job& job) :
+                    m_pipeline(pipeline),
+                    m_job(job) {
+                    // Empty
+                }
+
+                virtual void execute(WorkerData* workerData) override {
+                    m_pipeline->mesh(m_job, workerData);
+                }
+                virtual void cleanup() override {
+                    delete this;
+                }
+            private:
+                ChunkMeshPipeline* m_pipeline;
+                Job m_job;
+            };
+
+            /// Meshes a job on a worker and publishes the result
+            void mesh(const Job& job, WorkerData* worker);
+            /// Queues tasks for jobs that have already been counted as in flight
+            void enqueue(const Job* jobs, size_t count);
+            /// Marks polled results as no longer in flight
+            void release(size_t count);
+
+            vcore::ThreadPool<WorkerData> m_pool; ///< Worker threads
+            moodycamel::ConcurrentQueue<Result> m_results; ///< Finished meshes
+            std::unique_ptr<Policy> m_prototype; ///< Policy copied into each worker
+
+            mutable std::mutex m_lock; ///< Guards the counters below
+            std::condition_variable m_cond; ///< Signals released slots and drained queues
+            size_t m_inFlight = 0; ///< Submitted jobs whose results are not yet polled
+            size_t m_queued = 0; ///< Submitted jobs not yet meshed
+            size_t m_maxInFlight = 0; ///< Limit for m_inFlight
+
+            std::atomic<ui64> m_chunksMeshed = ATOMIC_VAR_INIT(0); ///< Chunks meshed since resetStats
+            i64 m_busyNanoseconds = 0; ///< Wall time with queued work since resetStats
+            Clock::time_point m_busyStart; ///< Start of the current busy period
+            bool m_isInitialized = false; ///< True between init and destroy
+        };
+    }
+}
+namespace vvox = vorb::voxel;
+
+#include "ChunkMeshPipeline.inl"
+
+#endif // !Vorb_ChunkMeshPipeline_h__
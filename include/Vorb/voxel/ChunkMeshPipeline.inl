@@ -0,0 +1,166 @@
+template<typename T, typename Policy>
+vvox::ChunkMeshPipeline<T, Policy>::~ChunkMeshPipeline() {
+    destroy();
+}
+
+template<typename T, typename Policy>
+void vvox::ChunkMeshPipeline<T, Policy>::init(const Policy& policy, ui32 workers, size_t maxInFlight) {
+    if (m_isInitialized) return;
+    m_isInitialized = true;
+
+    m_prototype.reset(new Policy(policy));
+    m_maxInFlight = maxInFlight ? maxInFlight : 1;
+    resetStats();
+    m_pool.init(workers);
+}
+
+template<typename T, typename Policy>
+void vvox::ChunkMeshPipeline<T, Policy>::destroy() {
+    if (!m_isInitialized) return;
+
+    // Queued tasks delete themselves when they run, so let them finish
+    {
+        std::unique_lock<std::mutex> lock(m_lock);
+        m_cond.wait(lock, [&] { return m_queued == 0; });
+    }
+    m_pool.destroy();
+
+    // Drop unpolled results
+    Result result;
+    while (m_results.try_dequeue(result)) continue;
+
+    std::unique_lock<std::mutex> lock(m_lock);
+    m_inFlight = 0;
+    m_cond.notify_all();
+    lock.unlock();
+
+    m_prototype.reset();
+    m_isInitialized = false;
+}
+
+template<typename T, typename Policy>
+void vvox::ChunkMeshPipeline<T, Policy>::submit(const Job* jobs, size_t count) {
+    // Without workers the in-flight limit would never be released
+    vorb_assert(m_isInitialized, "ChunkMeshPipeline::submit called before init");
+    if (!m_isInitialized) return;
+
+    size_t i = 0;
+    while (i < count) {
+        size_t accepted;
+        {
+            std::unique_lock<std::mutex> lock(m_lock);
+            m_cond.wait(lock, [&] { return m_inFlight < m_maxInFlight; });
+            accepted = std::min(count - i, m_maxInFlight - m_inFlight);
+            if (m_queued == 0) m_busyStart = Clock::now();
+            m_inFlight += accepted;
+            m_queued += accepted;
+        }
+        enqueue(jobs + i, accepted);
+        i += accepted;
+    }
+}
+
+template<typename T, typename Policy>
+size_t vvox::ChunkMeshPipeline<T, Policy>::trySubmit(const Job* jobs, size_t count) {
+    if (!m_isInitialized) return 0;
+
+    size_t accepted;
+    {
+        std::unique_lock<std::mutex> lock(m_lock);
+        if (m_inFlight >= m_maxInFlight) return 0;
+        accepted = std::min(count, m_maxInFlight - m_inFlight);
+        if (accepted == 0) return 0;
+        if (m_queued == 0) m_busyStart = Clock::now();
+        m_inFlight += accepted;
+        m_queued += accepted;
+    }
+    enqueue(jobs, accepted);
+    return accepted;
+}
+
+template<typename T, typename Policy>
+bool vvox::ChunkMeshPipeline<T, Policy>::poll(OUT Result& result) {
+    if (!m_results.try_dequeue(result)) return false;
+    release(1);
+    return true;
+}
+
+template<typename T, typename Policy>
+size_t vvox::ChunkMeshPipeline<T, Policy>::poll(OUT Result* results, size_t maxResults) {
+    size_t count = m_results.try_dequeue_bulk(results, maxResults);
+    if (count) release(count);
+    return count;
+}
+
+template<typename T, typename Policy>
+f64 vvox::ChunkMeshPipeline<T, Policy>::getThroughput() const {
+    i64 busy;
+    {
+        std::unique_lock<std::mutex> lock(m_lock);
+        busy = m_busyNanoseconds;
+        if (m_queued) busy += std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - m_busyStart).count();
+    }
+    if (busy <= 0) return 0.0;
+    return (f64)m_chunksMeshed * 1e9 / (f64)busy;
+}
+
+template<typename T, typename Policy>
+void vvox::ChunkMeshPipeline<T, Policy>::resetStats() {
+    std::unique_lock<std::mutex> lock(m_lock);
+    m_chunksMeshed = 0;
+    m_busyNanoseconds = 0;
+    m_busyStart = Clock::now();
+}
+
+template<typename T, typename Policy>
+void vvox::ChunkMeshPipeline<T, Policy>::mesh(const Job& job, WorkerData* worker) {
+    if (!worker->policy) worker->policy.reset(new Policy(*m_prototype));
+
+    // Gather quads into the worker's scratch, which keeps its capacity between chunks
+    worker->quads.clear();
+    if (job.mesher) {
+        job.mesher(job.view, *worker->policy, worker->quads);
+    } else {
+        MeshAPI api;
+        api.worker = worker;
+        meshalg::createCulled(job.view, &api);
+    }
+
+    // Pack into an exactly sized stream, the index pattern is shared by every mesh
+    size_t quadCount = worker->quads.size();
+    Result result;
+    result.id = job.id;
+    result.vertices.resize(quadCount * 4);
+    for (size_t i = 0; i < quadCount; i++) {
+        worker->policy->generateQuad(job.view, worker->quads[i], &result.vertices[i * 4]);
+    }
+
+    m_results.enqueue(std::move(result));
+    m_chunksMeshed++;
+
+    {
+        std::unique_lock<std::mutex> lock(m_lock);
+        m_queued--;
+        if (m_queued != 0) return;
+        m_busyNanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - m_busyStart).count();
+    }
+    m_cond.notify_all();
+}
+
+template<typename T, typename Policy>
+void vvox::ChunkMeshPipeline<T, Policy>::enqueue(const Job* jobs, size_t count) {
+    std::vector<vcore::IThreadPoolTask<WorkerData>*> tasks(count);
+    for (size_t i = 0; i < count; i++) {
+        tasks[i] = new MeshTask(this, jobs[i]);
+    }
+    m_pool.addTasks(tasks.data(), count);
+}
+
+template<typename T, typename Policy>
+void vvox::ChunkMeshPipeline<T, Policy>::release(size_t count) {
+    {
+        std::unique_lock<std::mutex> lock(m_lock);
+        m_inFlight -= count;
+    }
+    m_cond.notify_all();
+}
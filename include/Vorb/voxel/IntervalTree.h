@@ -19,59 +19,80 @@
 //! @endcond
 
 #ifndef VORB_USING_PCH
+#include <algorithm>
+#include <cstring>
 #include <map>
+#include <type_traits>
+#include <vector>
 
 #include "../types.h"
+#include "../VorbAssert.hpp"
 #endif // !VORB_USING_PCH
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define VORB_INTERVAL_TREE_SSE2
+#include <emmintrin.h>
+#endif
+
 // Implementation of a specialized interval tree based on a red-black tree
 // Red black tree: http://en.wikipedia.org/wiki/Red%E2%80%93black_tree
-
-// NOTE: Currently only works for lengths 32768 and below
-// TODO(Ben): More templatey
-// TODO(Ben): Recombination
+//
+// Reads can also go through a flat lookup: a sorted array of run starts with the
+// matching run data, searched with a branchless binary search. The lookup is
+// invalidated by writes and only rebuilt by explicit updateLookup() calls, so reads
+// never modify the tree and may run concurrently.
+
+// S is the unsigned type of interval starts and lengths, and its signed counterpart
+// indexes nodes. The top bit of a start stores the node color, so the total length
+// is limited to 2^(bits - 1): ui16 (the default) covers 32^3 chunks in the same
+// compact layout as before, ui32 is needed for 64^3 chunks.
 // TODO(Ben): Refactor
-template <typename T>
+template <typename T, typename S = ui16>
 class IntervalTree {
 public:
+    static_assert(std::is_unsigned<S>::value, "IntervalTree start/length type must be unsigned");
 
-#define COLOR_BIT 0x8000u
-#define START_MASK 0x7FFFu
+    typedef S LengthType; ///< Type of interval starts and lengths
+    typedef typename std::make_signed<S>::type NodeIndex; ///< Type of node links
+
+    static const S COLOR_BIT = (S)((S)1 << (sizeof(S) * 8 - 1)); ///< Bit of a start that stores node color
+    static const S START_MASK = (S)~COLOR_BIT; ///< Bits of a start that store the start
+    static const size_t MAX_LENGTH = (size_t)COLOR_BIT; ///< Largest total length a tree can cover
 
     // Lightweight node for initialization
     class LNode {
     public:
         LNode() {}
-        LNode(ui16 Start, ui16 Length, T Data) : start(Start), length(Length), data(Data) {}
-        void set(ui16 Start, ui16 Length, T Data) {
+        LNode(S Start, S Length, T Data) : start(Start), length(Length), data(Data) {}
+        void set(S Start, S Length, T Data) {
             start = Start;
             length = Length;
             data = Data;
         }
-        ui16 start;
-        ui16 length;
+        S start;
+        S length;
         T data;
     };
 
     class Node {
     public:
         Node() : left(-1), right(-1), parent(-2) {}
-        Node(T Data, ui16 start, ui16 Length) : length(Length), left(-1), right(-1), parent(-1), m_start(start | COLOR_BIT), data(Data)  {}
+        Node(T Data, S start, S Length) : length(Length), left(-1), right(-1), parent(-1), m_start(start | COLOR_BIT), data(Data)  {}
 
         inline void incrementStart() { ++m_start; }
         inline void decrementStart() { --m_start; }
-        inline ui16 getStart() const { return m_start & START_MASK; }
-        inline void setStart(ui16 Start) { m_start = (m_start & COLOR_BIT) | Start; }
+        inline S getStart() const { return m_start & START_MASK; }
+        inline void setStart(S Start) { m_start = (m_start & COLOR_BIT) | Start; }
         inline void paintRed() { m_start |= COLOR_BIT; }
         inline void paintBlack() { m_start &= START_MASK; }
         inline bool isRed() const { return (m_start & COLOR_BIT) != 0; }
 
-        ui16 length;
-        i16 left;
-        i16 right;
-        i16 parent;
+        S length;
+        NodeIndex left;
+        NodeIndex right;
+        NodeIndex parent;
     private:
-        ui16 m_start; //also stores color
+        S m_start; //also stores color
     public:
         T data;
     };
@@ -109,19 +130,25 @@ public:
         std::vector <Node>* m_tree;
     };
 
+    /// @param length: Length of the single interval, at most MAX_LENGTH
     void initSingle(T data, size_t length);
+    /// Build the tree from runs sorted by start, whose lengths sum to at most MAX_LENGTH
     void initFromSortedArray(const std::vector <LNode>& data);
     void initFromSortedArray(const LNode data[], size_t size);
+    /// Compress a flat array into the tree, leaving the flat lookup valid
+    /// @param data: Array of length values
+    /// @param length: Number of values, at most MAX_LENGTH
+    void initFromFlatArray(const T* data, size_t length);
 
     bool checkTreeValidity() const {
-        int tot = 0;
+        size_t tot = 0;
         for (size_t i = 0; i < m_tree.size(); i++) {
-            if (m_tree[i].length > 32768) {
+            if (m_tree[i].length > m_length) {
                 return false;
             }
             tot += m_tree[i].length;
         }
-        if (tot != 32768) {
+        if (tot != m_length) {
             return false;
         }
 
@@ -156,15 +183,45 @@ public:
 
     void clear();
 
+    /// Get the data at a point, through the flat lookup if it is up to date
     const T& getData(size_t index) const;
+    /// Get the data at a point and the bounds of the run that holds it
+    /// @param index: Point to look up
+    /// @param runStart: Receives the first index of the run
+    /// @param runEnd: Receives one past the last index of the run
+    /// @return Data of the run
+    const T& getRun(size_t index, OUT size_t& runStart, OUT size_t& runEnd) const;
+    /// Rebuild the flat lookup, call after a batch of writes
+    /// The lookup of an empty tree stays invalid.
+    void updateLookup();
+    /// @return True if reads are served by the flat lookup
+    bool isLookupValid() const { return !m_isLookupDirty; }
     //Get the enclosing interval for a given point
-    i16 getInterval(size_t index) const;
+    NodeIndex getInterval(size_t index) const;
 
     Node* insert(size_t index, T data);
 
-    void uncompressIntoBuffer(T* buffer);
+    /// Apply many point writes in one pass, merging adjacent runs with equal data
+    /// @param writes: (index, data) pairs in any order, later writes to an index win
+    void insertBatch(const std::vector<std::pair<size_t, T> >& writes);
+    /// Apply many range writes in one pass, merging adjacent runs with equal data
+    /// @param ranges: Runs to write in any order, later ranges overwrite earlier ones
+    /// Parts of a range beyond the tree's length are ignored.
+    void insertRanges(const std::vector<LNode>& ranges);
+    void insertRanges(const LNode ranges[], size_t count);
+    /// Merge all adjacent runs with equal data and rebalance the tree
+    /// Single-voxel inserts never merge runs, so call this after many of them.
+    void recombine();
+
+    /// Append all runs in order of increasing start
+    void gatherRuns(OUT std::vector<LNode>& runs) const;
+    /// Expand every run into a flat array
+    /// @param buffer: Array of at least length() values
+    void uncompressIntoBuffer(T* buffer) const;
 
     iterator begin() { 
+        // Nodes may be modified through the iterator
+        m_isLookupDirty = true;
         if (m_root == -1) return iterator(nullptr, nullptr);
         return iterator(&m_tree[m_root], &m_tree);
     }
@@ -178,9 +235,29 @@ public:
 
     inline const Node& operator[](int index) const { return m_tree[index]; }
     inline size_t size() const { return m_tree.size(); }
+    /// @return The total length covered by the tree
+    inline size_t length() const { return m_length; }
 
 private:
-    void uncompressTraversal(int index, int& bufferIndex, T* buffer);
+    /// @return The end of the run of values equal to data[start], at most length
+    static size_t findRunEnd(const T* data, size_t start, size_t length);
+    /// Write count copies of value to buffer
+    static void fillRun(T* buffer, const T& value, size_t count);
+
+    /// Invoke f on every node in order of increasing start without recursion
+    template<typename F>
+    void traverseInOrder(F f) const;
+
+    /// Rebuild a balanced tree from sorted runs, merging adjacent runs with equal data
+    void rebuildFromRuns(std::vector<LNode>& runs);
+
+    /// Branchless binary search of the flat lookup
+    /// @return Position of the run holding index in the lookup arrays
+    size_t lookupRun(size_t index) const;
+    const T& lookupData(size_t index) const {
+        vorb_assert(!m_lookupStarts.empty() && index < m_length, "Lookup of index " << index << " outside the tree");
+        return m_lookupData[lookupRun(index)];
+    }
 
     int arrayToRedBlackTree(int i, int j, int parent, bool isBlack) {
         if (i > j) return -1;
@@ -222,17 +299,22 @@ private:
 
     int m_root = -1;
     std::vector <Node> m_tree;
+    size_t m_length = 0; ///< Total length covered by all intervals
+
+    std::vector <S> m_lookupStarts; ///< Sorted run starts
+    std::vector <T> m_lookupData; ///< Run data matching m_lookupStarts
+    bool m_isLookupDirty = true; ///< True when a write happened since the last updateLookup()
 
     class NodeToAdd {
     public:
-        NodeToAdd(i16 Parent, ui16 Length, T Data) : start(Parent), length(Length), data(Data) {}
-        i16 start;
-        ui16 length;
+        NodeToAdd(S Start, S Length, T Data) : start(Start), length(Length), data(Data) {}
+        S start;
+        S length;
         T data;
     };
 
     std::vector <NodeToAdd> m_nodesToAdd;
-    std::vector <ui16> m_nodesToRemove;
+    std::vector <S> m_nodesToRemove;
 };
 
 #include "IntervalTree.inl"
@@ -1,48 +1,259 @@
-template <typename T>
-inline void IntervalTree<T>::initSingle(T data, size_t length) {
+template <typename T, typename S>
+inline void IntervalTree<T, S>::initSingle(T data, size_t length) {
+    vorb_assert(length <= MAX_LENGTH, "Tree of length " << length << " exceeds the start type");
+    m_isLookupDirty = true;
+    m_length = length;
     m_root = 0;
     m_tree.emplace_back(data, 0, length);
     m_tree[0].paintBlack();
 }
 
-template <typename T>
-void IntervalTree<T>::initFromSortedArray(const std::vector <LNode>& data) {
+template <typename T, typename S>
+void IntervalTree<T, S>::initFromSortedArray(const std::vector <LNode>& data) {
+    m_isLookupDirty = true;
     m_tree.resize(data.size());
+    m_length = 0;
     for (size_t i = 0; i < m_tree.size(); i++) {
         m_tree[i].setStart(data[i].start);
         m_tree[i].length = data[i].length;
         m_tree[i].data = data[i].data;
+        m_length += data[i].length;
     }
+    vorb_assert(m_length <= MAX_LENGTH, "Tree of length " << m_length << " exceeds the start type");
     m_root = arrayToRedBlackTree(0, data.size() - 1, -1, true);
 }
 
-template <typename T>
-inline void IntervalTree<T>::initFromSortedArray(const LNode data[], size_t size) {
+template <typename T, typename S>
+inline void IntervalTree<T, S>::initFromSortedArray(const LNode data[], size_t size) {
+    m_isLookupDirty = true;
     m_tree.resize(size);
+    m_length = 0;
     for (size_t i = 0; i < size; i++) {
         m_tree[i].setStart(data[i].start);
         m_tree[i].length = data[i].length;
         m_tree[i].data = data[i].data;
+        m_length += data[i].length;
     }
+    vorb_assert(m_length <= MAX_LENGTH, "Tree of length " << m_length << " exceeds the start type");
     m_root = arrayToRedBlackTree(0, size - 1, -1, true);
 }
 
-template <typename T>
-inline void IntervalTree<T>::clear() {
+template <typename T, typename S>
+inline void IntervalTree<T, S>::clear() {
     std::vector<Node>().swap(m_tree);
     std::vector<NodeToAdd>().swap(m_nodesToAdd);
-    std::vector<ui16>().swap(m_nodesToRemove);
+    std::vector<S>().swap(m_nodesToRemove);
+    std::vector<S>().swap(m_lookupStarts);
+    std::vector<T>().swap(m_lookupData);
+    m_isLookupDirty = true;
+    m_length = 0;
     m_root = -1;
 }
 
-template <typename T>
-inline const T& IntervalTree<T>::getData(size_t index) const {
+template <typename T, typename S>
+inline const T& IntervalTree<T, S>::getData(size_t index) const {
+    if (!m_isLookupDirty) return lookupData(index);
     return m_tree[getInterval(index)].data;
 }
 
+template <typename T, typename S>
+inline const T& IntervalTree<T, S>::getRun(size_t index, OUT size_t& runStart, OUT size_t& runEnd) const {
+    if (!m_isLookupDirty) {
+        size_t run = lookupRun(index);
+        runStart = m_lookupStarts[run];
+        runEnd = run + 1 < m_lookupStarts.size() ? m_lookupStarts[run + 1] : m_length;
+        return m_lookupData[run];
+    }
+    const Node& node = m_tree[getInterval(index)];
+    runStart = node.getStart();
+    runEnd = runStart + node.length;
+    return node.data;
+}
+
+template <typename T, typename S>
+void IntervalTree<T, S>::updateLookup() {
+    m_lookupStarts.clear();
+    m_lookupData.clear();
+    m_lookupStarts.reserve(m_tree.size());
+    m_lookupData.reserve(m_tree.size());
+    traverseInOrder([&](const Node& node) {
+        m_lookupStarts.push_back(node.getStart());
+        m_lookupData.push_back(node.data);
+    });
+    // An empty lookup has no run to return, leave reads to the tree
+    m_isLookupDirty = m_lookupStarts.empty();
+}
+
+template <typename T, typename S>
+template <typename F>
+void IntervalTree<T, S>::traverseInOrder(F f) const {
+    if (m_root == -1) return;
+
+    // Red-black trees are at most 2 * log2(n + 1) high, so this rarely grows
+    std::vector<i32> stack;
+    stack.reserve(64);
+    i32 current = m_root;
+    while (current != -1 || stack.size()) {
+        while (current != -1) {
+            stack.push_back(current);
+            current = m_tree[current].left;
+        }
+        current = stack.back();
+        stack.pop_back();
+        f(m_tree[current]);
+        current = m_tree[current].right;
+    }
+}
+
+template <typename T, typename S>
+void IntervalTree<T, S>::gatherRuns(OUT std::vector<LNode>& runs) const {
+    runs.reserve(runs.size() + m_tree.size());
+    traverseInOrder([&](const Node& node) {
+        runs.emplace_back(node.getStart(), node.length, node.data);
+    });
+}
+
+template <typename T, typename S>
+void IntervalTree<T, S>::rebuildFromRuns(std::vector<LNode>& runs) {
+    // Coalesce in place
+    size_t count = 0;
+    for (size_t i = 0; i < runs.size(); i++) {
+        if (!runs[i].length) continue;
+        if (count && runs[count - 1].data == runs[i].data) {
+            runs[count - 1].length += runs[i].length;
+        } else {
+            runs[count++] = runs[i];
+        }
+    }
+    runs.resize(count);
+
+    std::vector<NodeToAdd>().swap(m_nodesToAdd);
+    m_tree.clear();
+    initFromSortedArray(runs);
+}
+
+template <typename T, typename S>
+void IntervalTree<T, S>::recombine() {
+    std::vector<LNode> runs;
+    gatherRuns(runs);
+    if (runs.empty()) return;
+    rebuildFromRuns(runs);
+}
+
+template <typename T, typename S>
+void IntervalTree<T, S>::insertBatch(const std::vector<std::pair<size_t, T> >& writes) {
+    std::vector<LNode> ranges;
+    ranges.reserve(writes.size());
+    for (auto& write : writes) {
+        // Filter before narrowing, or indices beyond the range of S would wrap into the tree
+        if (write.first >= m_length) continue;
+        ranges.emplace_back((S)write.first, (S)1, write.second);
+    }
+    insertRanges(ranges);
+}
+
+template <typename T, typename S>
+inline void IntervalTree<T, S>::insertRanges(const std::vector<LNode>& ranges) {
+    insertRanges(ranges.data(), ranges.size());
+}
+
+template <typename T, typename S>
+void IntervalTree<T, S>::insertRanges(const LNode ranges[], size_t count) {
+    if (m_root == -1 || !count) return;
+
+    // Clip the ranges to the tree and order them by start
+    struct Clipped {
+        size_t start;
+        size_t end;
+        size_t order; ///< Position in ranges, later ranges win
+    };
+    std::vector<Clipped> clipped;
+    clipped.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        size_t rStart = ranges[i].start;
+        size_t rEnd = std::min(rStart + ranges[i].length, m_length);
+        if (rStart < rEnd) clipped.push_back({ rStart, rEnd, i });
+    }
+    if (clipped.empty()) return;
+    std::sort(clipped.begin(), clipped.end(), [](const Clipped& a, const Clipped& b) {
+        return a.start < b.start;
+    });
+
+    // Sweep the starts, painting with the latest range covering each point. Ranges that
+    // ended are only dropped from the heap once they reach the top.
+    std::vector<LNode> painted;
+    painted.reserve(clipped.size() * 2);
+    std::vector<std::pair<size_t, size_t> > active; // Heap of (order, end)
+    size_t next = 0;
+    size_t pos = clipped[0].start;
+    while (next < clipped.size() || !active.empty()) {
+        if (active.empty()) pos = clipped[next].start;
+        while (next < clipped.size() && clipped[next].start <= pos) {
+            active.emplace_back(clipped[next].order, clipped[next].end);
+            std::push_heap(active.begin(), active.end());
+            next++;
+        }
+        while (!active.empty() && active.front().second <= pos) {
+            std::pop_heap(active.begin(), active.end());
+            active.pop_back();
+        }
+        if (active.empty()) continue;
+
+        size_t end = active.front().second;
+        if (next < clipped.size()) end = std::min(end, clipped[next].start);
+        const T& data = ranges[active.front().first].data;
+        if (!painted.empty() && (size_t)painted.back().start + painted.back().length == pos && painted.back().data == data) {
+            painted.back().length += (S)(end - pos);
+        } else {
+            painted.emplace_back((S)pos, (S)(end - pos), data);
+        }
+        pos = end;
+    }
+
+    std::vector<LNode> runs;
+    gatherRuns(runs);
+
+    // Single sweep over the old runs, substituting written ranges
+    std::vector<LNode> merged;
+    merged.reserve(runs.size() + painted.size() * 2);
+    size_t w = 0;
+    for (auto& run : runs) {
+        size_t pos = run.start;
+        size_t end = (size_t)run.start + run.length;
+        while (pos < end) {
+            while (w < painted.size() && (size_t)painted[w].start + painted[w].length <= pos) w++;
+            size_t next;
+            if (w < painted.size() && painted[w].start <= pos) {
+                next = std::min((size_t)painted[w].start + painted[w].length, end);
+                merged.emplace_back((S)pos, (S)(next - pos), painted[w].data);
+            } else {
+                next = (w < painted.size()) ? std::min((size_t)painted[w].start, end) : end;
+                merged.emplace_back((S)pos, (S)(next - pos), run.data);
+            }
+            pos = next;
+        }
+    }
+
+    rebuildFromRuns(merged);
+}
+
+template <typename T, typename S>
+inline size_t IntervalTree<T, S>::lookupRun(size_t index) const {
+    // Find the last start <= index. The ternary compiles to a conditional move,
+    // so the loop has a fixed trip count and no unpredictable branches.
+    const S* base = m_lookupStarts.data();
+    size_t n = m_lookupStarts.size();
+    while (n > 1) {
+        size_t half = n >> 1;
+        base = (base[half] <= index) ? base + half : base;
+        n -= half;
+    }
+    return base - m_lookupStarts.data();
+}
+
 //Get the enclosing interval for a given point
-template <typename T>
-i16 IntervalTree<T>::getInterval(size_t index) const {
+template <typename T, typename S>
+typename IntervalTree<T, S>::NodeIndex IntervalTree<T, S>::getInterval(size_t index) const {
     i32 interval = m_root;
     while (true) {
 
@@ -65,8 +276,8 @@ i16 IntervalTree<T>::getInterval(size_t index) const {
     }
 }
 
-template <typename T>
-bool IntervalTree<T>::treeInsert(int index, T data, int &newIndex) {
+template <typename T, typename S>
+bool IntervalTree<T, S>::treeInsert(int index, T data, int &newIndex) {
     int interval = m_root;
     Node* enclosingInterval = nullptr;
 //    int enclosingIndex = -1;
@@ -78,7 +289,7 @@ bool IntervalTree<T>::treeInsert(int index, T data, int &newIndex) {
             //Check if we are at the leaf
             if (node.left == -1) {
                 //check if we are right before the current node               
-                if (index == node.getStart() - 1) {
+                if (index == (int)node.getStart() - 1) {
 
                     if (enclosingInterval) {
                         --(enclosingInterval->length);
@@ -119,12 +330,12 @@ bool IntervalTree<T>::treeInsert(int index, T data, int &newIndex) {
                 return true;
             }
             interval = node.left;
-        } else if (index < node.getStart() + node.length) { //we are in the nodes interval
+        } else if (index < (int)(node.getStart() + node.length)) { //we are in the nodes interval
 
             if (node.data == data) {
                 newIndex = interval;
                 return false;
-            } else if (node.getStart() == index) { //check if we are at the start of the interval
+            } else if ((int)node.getStart() == index) { //check if we are at the start of the interval
                 //check for interval replacement
                 if (node.length == 1) {
                     node.data = data;
@@ -157,7 +368,7 @@ bool IntervalTree<T>::treeInsert(int index, T data, int &newIndex) {
                     node.right = m_tree.size();
                     newIndex = node.right;
 
-                    if (index == node.getStart() + node.length - 1) { //at the edge of the interval
+                    if (index == (int)(node.getStart() + node.length) - 1) { //at the edge of the interval
                         --(enclosingInterval->length);
                     } else { //splitting the interval
                         m_nodesToAdd.emplace_back(index + 1, node.getStart() + node.length - index - 1, enclosingInterval->data);
@@ -191,8 +402,8 @@ bool IntervalTree<T>::treeInsert(int index, T data, int &newIndex) {
     }
 }
 
-template <typename T>
-inline int IntervalTree<T>::getGrandparent(Node* node) {
+template <typename T, typename S>
+inline int IntervalTree<T, S>::getGrandparent(Node* node) {
     if (node->parent != -1) {
         return m_tree[node->parent].parent;
     } else {
@@ -200,8 +411,8 @@ inline int IntervalTree<T>::getGrandparent(Node* node) {
     }
 }
 
-template <typename T>
-inline int IntervalTree<T>::getUncle(Node* node, Node** grandParent) {
+template <typename T, typename S>
+inline int IntervalTree<T, S>::getUncle(Node* node, Node** grandParent) {
     int grandparentIndex = getGrandparent(node);
     if (grandparentIndex == -1) {
         *grandParent = nullptr;
@@ -218,10 +429,10 @@ inline int IntervalTree<T>::getUncle(Node* node, Node** grandParent) {
     }
 }
 
-template <typename T>
-inline void IntervalTree<T>::rotateParentLeft(int index, Node* grandParent) {
+template <typename T, typename S>
+inline void IntervalTree<T, S>::rotateParentLeft(int index, Node* grandParent) {
     Node& node = m_tree[index];
-    i16 parentIndex = node.parent;
+    NodeIndex parentIndex = node.parent;
     Node& parent = m_tree[parentIndex];
 
     node.parent = parent.parent;
@@ -236,10 +447,10 @@ inline void IntervalTree<T>::rotateParentLeft(int index, Node* grandParent) {
 
 }
 
-template <typename T>
-inline void IntervalTree<T>::rotateParentRight(int index, Node* grandParent) {
+template <typename T, typename S>
+inline void IntervalTree<T, S>::rotateParentRight(int index, Node* grandParent) {
     Node& node = m_tree[index];
-    i16 parentIndex = node.parent;
+    NodeIndex parentIndex = node.parent;
     Node& parent = m_tree[parentIndex];
 
     node.parent = parent.parent;
@@ -253,13 +464,13 @@ inline void IntervalTree<T>::rotateParentRight(int index, Node* grandParent) {
     node.right = parentIndex;
 }
 
-template <typename T>
-inline void IntervalTree<T>::rotateRight(int index) {
+template <typename T, typename S>
+inline void IntervalTree<T, S>::rotateRight(int index) {
 
     Node& node = m_tree.at(index);
     Node& left = m_tree.at(node.left);
 
-    i16 right = left.right;
+    NodeIndex right = left.right;
     left.right = index;
     left.parent = node.parent;
 
@@ -280,13 +491,13 @@ inline void IntervalTree<T>::rotateRight(int index) {
 
 }
 
-template <typename T>
-inline void IntervalTree<T>::rotateLeft(int index) {
+template <typename T, typename S>
+inline void IntervalTree<T, S>::rotateLeft(int index) {
 
     Node& node = m_tree.at(index);
     Node& right = m_tree.at(node.right);
 
-    i16 left = right.left;
+    NodeIndex left = right.left;
     right.left = index;
     right.parent = node.parent;
 
@@ -306,27 +517,138 @@ inline void IntervalTree<T>::rotateLeft(int index) {
     }
 }
 
-template <typename T>
-void IntervalTree<T>::uncompressTraversal(int index, int& bufferIndex, T* buffer) {
-    if (m_tree[index].left != -1) {
-        uncompressTraversal(m_tree[index].left, bufferIndex, buffer);
+namespace IntervalTreeSIMD {
+    /// Values that can be compared and broadcast bitwise, 1, 2 or 4 bytes wide
+    template <typename T>
+    struct IsVectorizable {
+#ifdef VORB_INTERVAL_TREE_SSE2
+        static const bool value = (std::is_integral<T>::value || std::is_enum<T>::value) &&
+            (sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4);
+#else
+        static const bool value = false;
+#endif
+    };
+
+    template <typename T>
+    inline size_t findRunEnd(const T* data, size_t start, size_t length, std::false_type) {
+        size_t i = start + 1;
+        for (; i < length && data[i] == data[start]; i++);
+        return i;
+    }
+
+    template <typename T>
+    inline void fillRun(T* buffer, const T& value, size_t count, std::false_type) {
+        std::fill_n(buffer, count, value);
+    }
+
+#ifdef VORB_INTERVAL_TREE_SSE2
+    inline __m128i broadcast(ui8 v) { return _mm_set1_epi8((char)v); }
+    inline __m128i broadcast(ui16 v) { return _mm_set1_epi16((short)v); }
+    inline __m128i broadcast(ui32 v) { return _mm_set1_epi32((int)v); }
+
+    /// Broadcast the bits of a value to all lanes
+    template <typename T>
+    inline __m128i broadcastBits(const T& value) {
+        typedef typename std::conditional<sizeof(T) == 1, ui8,
+            typename std::conditional<sizeof(T) == 2, ui16, ui32>::type>::type Bits;
+        Bits bits;
+        std::memcpy(&bits, &value, sizeof(T));
+        return broadcast(bits);
+    }
+
+    inline ui32 countTrailingZeros(ui32 v) {
+#if defined(VORB_COMPILER_MSVC)
+        unsigned long i;
+        _BitScanForward(&i, v);
+        return (ui32)i;
+#else
+        return (ui32)__builtin_ctz(v);
+#endif
+    }
+
+    template <typename T>
+    inline size_t findRunEnd(const T* data, size_t start, size_t length, std::true_type) {
+        const size_t WIDTH = 16 / sizeof(T);
+        size_t i = start + 1;
+        // Noisy data is mostly single-voxel runs, skip the vector setup for them
+        if (i >= length || !(data[i] == data[start])) return i;
+        __m128i value = broadcastBits(data[start]);
+        // Compare 16 bytes at a time, the first differing byte marks the end of the run
+        for (; i + WIDTH <= length; i += WIDTH) {
+            __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+            ui32 equal = (ui32)_mm_movemask_epi8(_mm_cmpeq_epi8(block, value));
+            if (equal != 0xFFFFu) return i + countTrailingZeros(~equal & 0xFFFFu) / sizeof(T);
+        }
+        for (; i < length && data[i] == data[start]; i++);
+        return i;
     }
-    for (int i = 0; i < m_tree[index].length; i++) {
-        buffer[bufferIndex++] = m_tree[index].data;
+
+    template <typename T>
+    inline void fillRun(T* buffer, const T& value, size_t count, std::true_type) {
+        const size_t WIDTH = 16 / sizeof(T);
+        __m128i v = broadcastBits(value);
+        size_t i = 0;
+        for (; i + WIDTH <= count; i += WIDTH) {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(buffer + i), v);
+        }
+        for (; i < count; i++) buffer[i] = value;
     }
-    if (m_tree[index].right != -1) {
-        uncompressTraversal(m_tree[index].right, bufferIndex, buffer);
+#endif // VORB_INTERVAL_TREE_SSE2
+}
+
+template <typename T, typename S>
+inline size_t IntervalTree<T, S>::findRunEnd(const T* data, size_t start, size_t length) {
+    typedef std::integral_constant<bool, IntervalTreeSIMD::IsVectorizable<T>::value> Vectorize;
+    return IntervalTreeSIMD::findRunEnd(data, start, length, Vectorize());
+}
+
+template <typename T, typename S>
+inline void IntervalTree<T, S>::fillRun(T* buffer, const T& value, size_t count) {
+    typedef std::integral_constant<bool, IntervalTreeSIMD::IsVectorizable<T>::value> Vectorize;
+    IntervalTreeSIMD::fillRun(buffer, value, count, Vectorize());
+}
+
+template <typename T, typename S>
+void IntervalTree<T, S>::initFromFlatArray(const T* data, size_t length) {
+    vorb_assert(length <= MAX_LENGTH, "Tree of length " << length << " exceeds the start type");
+    std::vector<NodeToAdd>().swap(m_nodesToAdd);
+    m_lookupStarts.clear();
+    m_lookupData.clear();
+    m_tree.clear();
+
+    // Nodes are written in order, then linked up as a balanced tree
+    for (size_t start = 0; start < length;) {
+        size_t end = findRunEnd(data, start, length);
+        m_tree.emplace_back(data[start], (S)start, (S)(end - start));
+        m_lookupStarts.push_back((S)start);
+        m_lookupData.push_back(data[start]);
+        start = end;
     }
+    m_length = length;
+    m_root = arrayToRedBlackTree(0, (int)m_tree.size() - 1, -1, true);
+
+    // The runs are already in order, so the lookup comes for free
+    m_isLookupDirty = m_lookupStarts.empty();
 }
 
-template <typename T>
-void IntervalTree<T>::uncompressIntoBuffer(T* buffer) {
-    int bufferIndex = 0;
-    uncompressTraversal(m_root, bufferIndex, buffer);
+template <typename T, typename S>
+void IntervalTree<T, S>::uncompressIntoBuffer(T* buffer) const {
+    if (!m_isLookupDirty) {
+        size_t runs = m_lookupStarts.size();
+        for (size_t i = 0; i < runs; i++) {
+            size_t end = (i + 1 < runs) ? (size_t)m_lookupStarts[i + 1] : m_length;
+            fillRun(buffer + m_lookupStarts[i], m_lookupData[i], end - m_lookupStarts[i]);
+        }
+        return;
+    }
+    traverseInOrder([&](const Node& node) {
+        fillRun(buffer + node.getStart(), node.data, node.length);
+    });
 }
 
-template <typename T>
-typename IntervalTree<T>::Node* IntervalTree<T>::insert(size_t index, T data) {
+template <typename T, typename S>
+typename IntervalTree<T, S>::Node* IntervalTree<T, S>::insert(size_t index, T data) {
+    m_isLookupDirty = true;
 
     int nodeIndex;
     if (!treeInsert(index, data, nodeIndex)) {
@@ -423,14 +745,14 @@ typename IntervalTree<T>::Node* IntervalTree<T>::insert(size_t index, T data) {
 }
 
 // Iterators
-template <typename T>
-IntervalTree<T>::iterator::iterator(pointer ptr, std::vector <Node>* tree) : m_ptr(ptr), m_tree(tree) {
+template <typename T, typename S>
+IntervalTree<T, S>::iterator::iterator(pointer ptr, std::vector <Node>* tree) : m_ptr(ptr), m_tree(tree) {
     if (m_ptr == nullptr) return;
     while (m_ptr->left != -1) m_ptr = &m_tree->operator[](m_ptr->left);
 }
 
-template <typename T>
-typename IntervalTree<T>::iterator::self_type IntervalTree<T>::iterator::operator++() {
+template <typename T, typename S>
+typename IntervalTree<T, S>::iterator::self_type IntervalTree<T, S>::iterator::operator++() {
     if (m_ptr == nullptr) throw std::runtime_error("Attempted to increment iterator at end.");
     self_type i = *this;
     pointer r = m_ptr;
@@ -456,14 +778,14 @@ typename IntervalTree<T>::iterator::self_type IntervalTree<T>::iterator::operato
     return i;
 }
 
-template <typename T>
-IntervalTree<T>::const_iterator::const_iterator(pointer ptr, std::vector <Node>* tree) : m_ptr(ptr), m_tree(tree) {
+template <typename T, typename S>
+IntervalTree<T, S>::const_iterator::const_iterator(pointer ptr, std::vector <Node>* tree) : m_ptr(ptr), m_tree(tree) {
     if (m_ptr == nullptr) return;
     while (m_ptr->left != -1) m_ptr = &m_tree->operator[](m_ptr->left);
 }
 
-template <typename T>
-typename IntervalTree<T>::const_iterator::self_type IntervalTree<T>::const_iterator::operator++() {
+template <typename T, typename S>
+typename IntervalTree<T, S>::const_iterator::self_type IntervalTree<T, S>::const_iterator::operator++() {
     if (m_ptr == nullptr) throw std::runtime_error("Attempted to increment const_iterator at end.");
     self_type i = *this;
     pointer r = m_ptr;
@@ -0,0 +1,171 @@
+//
+// PaletteContainer.h
+// Vorb Engine
+//
+// Created by the Vorb team on 18 Oct 2026
+// Copyright 2014 Regrowth Studios
+// MIT License
+//
+
+/*! \file PaletteContainer.h
+ * @brief Palette-compressed voxel storage with bit-packed indices.
+ */
+
+#pragma once
+
+#ifndef Vorb_PaletteContainer_h__
+//! @cond DOXY_SHOW_HEADER_GUARDS
+#define Vorb_PaletteContainer_h__
+//! @endcond
+
+#ifndef VORB_USING_PCH
+#include <cmath>
+#include <unordered_map>
+#include <vector>
+
+#include "../types.h"
+#include "../VorbAssert.hpp"
+#endif // !VORB_USING_PCH
+
+#include "IntervalTree.h"
+
+namespace vorb {
+    namespace voxel {
+        /// Stores voxels as a palette of distinct values and a bit-packed index per voxel
+        ///
+        /// Indices use 1 to 16 bits, widening as the palette grows. Unlike IntervalTree the
+        /// cost does not depend on how the voxels are arranged, which makes it the cheaper
+        /// choice for noisy chunks. Palette entries that are no longer referenced are only
+        /// dropped by compact(). T must be hashable with std::hash.
+        /// @tparam T: Voxel data type
+        template<typename T>
+        class PaletteContainer {
+        public:
+            static const ui32 MAX_BITS = 16; ///< Widest index
+            /// Most distinct values a container can reference at once
+            static const size_t MAX_PALETTE_SIZE = (size_t)1 << MAX_BITS;
+            /// Most voxels a container holds, keeping the widest indices within 32 MiB
+            static const size_t MAX_LENGTH = (size_t)1 << 24;
+
+            /// Fill the container with a single value
+            /// @param length: Number of voxels, at most MAX_LENGTH
+            /// @param value: Value of every voxel
+            void init(size_t length, const T& value);
+            /// Fill the container from a flat array
+            /// @param data: Array of length values
+            /// @param length: Number of voxels, at most MAX_LENGTH
+            void initFromFlatArray(const T* data, size_t length);
+            /// Fill the container from an IntervalTree
+            template<typename S>
+            void initFromIntervalTree(const IntervalTree<T, S>& tree);
+            void clear();
+
+            /// Get the value of a voxel
+            const T& get(size_t index) const {
+                return m_palette[readIndex(index)];
+            }
+            /// Set the value of a voxel, growing the palette and index width when needed
+            /// @pre The other voxels must not reference MAX_PALETTE_SIZE distinct values
+            void set(size_t index, const T& value);
+
+            /// Drop unreferenced palette entries and narrow the indices to fit
+            void compact();
+
+            /// Expand every voxel into a flat array
+            /// @param buffer: Array of at least length() values
+            void uncompressIntoBuffer(T* buffer) const;
+            /// Write the voxels into an IntervalTree, replacing its contents
+            template<typename S>
+            void toIntervalTree(OUT IntervalTree<T, S>& tree) const;
+
+            /// Getters
+            size_t length() const { return m_length; }
+            size_t getPaletteSize() const { return m_palette.size(); }
+            const ui32& getBitsPerIndex() const { return m_bits; }
+            const std::vector<T>& getPalette() const { return m_palette; }
+            /// @return Approximate heap memory used, in bytes
+            size_t getMemoryUsage() const;
+        private:
+            ui32 readIndex(size_t index) const {
+                return readPacked(m_words.data(), m_bits, index);
+            }
+            void writeIndex(size_t index, ui32 id) {
+                writePacked(m_words.data(), m_bits, index, id);
+            }
+            static ui32 readPacked(const ui64* words, ui32 bits, size_t index) {
+                size_t bit = index * bits;
+                size_t word = bit >> 6;
+                ui32 shift = bit & 63;
+                ui64 value = words[word] >> shift;
+                // Indices may straddle two words
+                if (shift + bits > 64) value |= words[word + 1] << (64 - shift);
+                return (ui32)(value & ((1ull << bits) - 1));
+            }
+            static void writePacked(ui64* words, ui32 bits, size_t index, ui32 id) {
+                size_t bit = index * bits;
+                size_t word = bit >> 6;
+                ui32 shift = bit & 63;
+                ui64 mask = (1ull << bits) - 1;
+                words[word] = (words[word] & ~(mask << shift)) | ((ui64)id << shift);
+                if (shift + bits > 64) {
+                    ui32 spill = 64 - shift;
+                    words[word + 1] = (words[word + 1] & ~(mask >> spill)) | ((ui64)id >> spill);
+                }
+            }
+
+            /// @return Index of value in the palette, adding it if needed
+            ui32 getPaletteIndex(const T& value);
+            /// Drop unreferenced palette entries, counting the voxel at replacedIndex as unreferenced
+            /// The index of that voxel is left arbitrary, so it must be written next.
+            void compact(size_t replacedIndex);
+            /// Rewrite all indices with a new width, remapping them through remap if given
+            void repack(ui32 bits, const ui32* remap);
+
+            /// @return Number of bits needed to index count palette entries
+            static ui32 bitsFor(size_t count) {
+                ui32 bits = 1;
+                while (((size_t)1 << bits) < count) bits++;
+                return bits;
+            }
+
+            std::vector<T> m_palette; ///< Distinct values
+            std::unordered_map<T, ui32> m_paletteIndices; ///< Palette position of each value
+            std::vector<ui64> m_words; ///< Bit-packed palette indices, one per voxel
+            ui32 m_bits = 1; ///< Bits per index
+            size_t m_length = 0; ///< Number of voxels
+        };
+
+        /// Which container stores a chunk more compactly
+        enum class VoxelStorage {
+            INTERVAL_TREE,
+            PALETTE
+        };
+
+        /// Measured statistics of a chunk's voxels and the cost of storing them
+        struct VoxelStorageEstimate {
+        public:
+            f64 entropy; ///< Shannon entropy of the values, in bits per voxel
+            size_t distinctValues; ///< Number of distinct values
+            size_t runs; ///< Number of runs in Y-Z-X order
+            size_t intervalTreeBytes; ///< Approximate memory as an IntervalTree
+            size_t paletteBytes; ///< Approximate memory as a PaletteContainer
+            VoxelStorage cheapest; ///< Representation with the smaller estimate
+        };
+
+        /// Measure a chunk and estimate its memory in each representation
+        ///
+        /// Runs drive the IntervalTree cost and the entropy bounds how many bits per voxel any
+        /// value coding needs, so layered terrain favours the tree while noisy chunks with
+        /// many short runs favour the palette.
+        /// @tparam S: Width of the IntervalTree that would be used
+        /// @param data: Voxels accessed Y-Z-X
+        /// @param length: Number of voxels
+        template<typename T, typename S = ui16>
+        VoxelStorageEstimate estimateStorage(const T* data, size_t length);
+    }
+}
+namespace vvox = vorb::voxel;
+
+#include "PaletteContainer.inl"
+
+#endif // !Vorb_PaletteContainer_h__
@@ -0,0 +1,162 @@
+template<typename T>
+void vvox::PaletteContainer<T>::init(size_t length, const T& value) {
+    vorb_assert(length <= MAX_LENGTH, "Palette container of " << length << " voxels exceeds MAX_LENGTH");
+    clear();
+    m_length = length;
+    m_palette.push_back(value);
+    m_paletteIndices[value] = 0;
+    m_bits = 1;
+    m_words.assign((length * m_bits + 63) / 64, 0);
+}
+
+template<typename T>
+void vvox::PaletteContainer<T>::initFromFlatArray(const T* data, size_t length) {
+    vorb_assert(length <= MAX_LENGTH, "Palette container of " << length << " voxels exceeds MAX_LENGTH");
+    clear();
+    m_length = length;
+
+    // Index with the widest type first, then narrow once the palette is known
+    static_assert(MAX_BITS <= 16, "Palette indices must fit the temporary ids");
+    std::vector<ui16> ids(length);
+    for (size_t i = 0; i < length; i++) {
+        ids[i] = (ui16)getPaletteIndex(data[i]);
+    }
+    m_bits = bitsFor(m_palette.size());
+    m_words.assign((length * m_bits + 63) / 64, 0);
+    for (size_t i = 0; i < length; i++) {
+        writeIndex(i, ids[i]);
+    }
+}
+
+template<typename T>
+template<typename S>
+void vvox::PaletteContainer<T>::initFromIntervalTree(const IntervalTree<T, S>& tree) {
+    std::vector<T> buffer(tree.length());
+    tree.uncompressIntoBuffer(buffer.data());
+    initFromFlatArray(buffer.data(), buffer.size());
+}
+
+template<typename T>
+void vvox::PaletteContainer<T>::clear() {
+    std::vector<T>().swap(m_palette);
+    std::unordered_map<T, ui32>().swap(m_paletteIndices);
+    std::vector<ui64>().swap(m_words);
+    m_bits = 1;
+    m_length = 0;
+}
+
+template<typename T>
+void vvox::PaletteContainer<T>::set(size_t index, const T& value) {
+    // Reclaim dead entries before the widest index runs out
+    if (m_palette.size() == MAX_PALETTE_SIZE && m_paletteIndices.find(value) == m_paletteIndices.end()) compact(index);
+    ui32 id = getPaletteIndex(value);
+    if (m_palette.size() > ((size_t)1 << m_bits)) repack(m_bits + 1, nullptr);
+    writeIndex(index, id);
+}
+
+template<typename T>
+void vvox::PaletteContainer<T>::compact() {
+    compact(m_length);
+}
+
+template<typename T>
+void vvox::PaletteContainer<T>::compact(size_t replacedIndex) {
+    // Count references to find the live entries
+    std::vector<ui32> counts(m_palette.size(), 0);
+    for (size_t i = 0; i < m_length; i++) {
+        if (i != replacedIndex) counts[readIndex(i)]++;
+    }
+
+    std::vector<ui32> remap(m_palette.size());
+    std::vector<T> palette;
+    m_paletteIndices.clear();
+    for (size_t i = 0; i < m_palette.size(); i++) {
+        if (!counts[i]) continue;
+        remap[i] = (ui32)palette.size();
+        m_paletteIndices[m_palette[i]] = (ui32)palette.size();
+        palette.push_back(m_palette[i]);
+    }
+    if (palette.empty() && !m_palette.empty()) {
+        // An empty container keeps its first value
+        palette.push_back(m_palette[0]);
+        m_paletteIndices[m_palette[0]] = 0;
+    }
+    m_palette.swap(palette);
+    repack(bitsFor(m_palette.size()), remap.data());
+}
+
+template<typename T>
+void vvox::PaletteContainer<T>::uncompressIntoBuffer(T* buffer) const {
+    for (size_t i = 0; i < m_length; i++) {
+        buffer[i] = m_palette[readIndex(i)];
+    }
+}
+
+template<typename T>
+template<typename S>
+void vvox::PaletteContainer<T>::toIntervalTree(OUT IntervalTree<T, S>& tree) const {
+    std::vector<T> buffer(m_length);
+    uncompressIntoBuffer(buffer.data());
+    tree.initFromFlatArray(buffer.data(), buffer.size());
+}
+
+template<typename T>
+size_t vvox::PaletteContainer<T>::getMemoryUsage() const {
+    // Hash nodes hold the pair plus a next pointer and a cached hash, with one bucket pointer each
+    size_t mapEntry = sizeof(std::pair<const T, ui32>) + 2 * sizeof(void*) + sizeof(size_t);
+    return m_words.capacity() * sizeof(ui64) +
+        m_palette.capacity() * sizeof(T) +
+        m_paletteIndices.size() * mapEntry;
+}
+
+template<typename T>
+ui32 vvox::PaletteContainer<T>::getPaletteIndex(const T& value) {
+    auto it = m_paletteIndices.find(value);
+    if (it != m_paletteIndices.end()) return it->second;
+    vorb_assert(m_palette.size() < MAX_PALETTE_SIZE, "Palette can't reference more than MAX_PALETTE_SIZE values");
+
+    ui32 id = (ui32)m_palette.size();
+    m_palette.push_back(value);
+    m_paletteIndices[value] = id;
+    return id;
+}
+
+template<typename T>
+void vvox::PaletteContainer<T>::repack(ui32 bits, const ui32* remap) {
+    std::vector<ui64> words((m_length * bits + 63) / 64, 0);
+    for (size_t i = 0; i < m_length; i++) {
+        ui32 id = readIndex(i);
+        writePacked(words.data(), bits, i, remap ? remap[id] : id);
+    }
+    m_words.swap(words);
+    m_bits = bits;
+}
+
+template<typename T, typename S>
+vvox::VoxelStorageEstimate vvox::estimateStorage(const T* data, size_t length) {
+    VoxelStorageEstimate estimate;
+    std::unordered_map<T, size_t> counts;
+    estimate.runs = 0;
+    for (size_t i = 0; i < length; i++) {
+        counts[data[i]]++;
+        if (i == 0 || !(data[i] == data[i - 1])) estimate.runs++;
+    }
+    estimate.distinctValues = counts.size();
+
+    estimate.entropy = 0.0;
+    for (auto& kvp : counts) {
+        f64 p = (f64)kvp.second / (f64)length;
+        estimate.entropy -= p * std::log2(p);
+    }
+
+    // Every run costs a tree node plus an entry of the flat lookup
+    estimate.intervalTreeBytes = estimate.runs * (sizeof(typename IntervalTree<T, S>::Node) + sizeof(S) + sizeof(T));
+
+    ui32 bits = 1;
+    while (((size_t)1 << bits) < estimate.distinctValues) bits++;
+    size_t mapEntry = sizeof(std::pair<const T, ui32>) + 2 * sizeof(void*) + sizeof(size_t);
+    estimate.paletteBytes = (length * bits + 63) / 64 * sizeof(ui64) + estimate.distinctValues * (sizeof(T) + mapEntry);
+
+    estimate.cheapest = estimate.paletteBytes < estimate.intervalTreeBytes ? VoxelStorage::PALETTE : VoxelStorage::INTERVAL_TREE;
+    return estimate;
+}
@@ -0,0 +1,178 @@
+//
+// RegionFile.h
+// Vorb Engine
+//
+// Created by the Vorb team on 18 Oct 2026
+// Copyright 2014 Regrowth Studios
+// MIT License
+//
+
+/*! \file RegionFile.h
+ * @brief Stores many compressed chunks in a single file.
+ */
+
+#pragma once
+
+#ifndef Vorb_RegionFile_h__
+//! @cond DOXY_SHOW_HEADER_GUARDS
+#define Vorb_RegionFile_h__
+//! @endcond
+
+#ifndef VORB_USING_PCH
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "../types.h"
+#endif // !VORB_USING_PCH
+
+#include "../io/MappedFile.h"
+#include "../io/Path.h"
+#include "IntervalTree.h"
+
+namespace vorb {
+    namespace voxel {
+        /// Location of a chunk's blob within a region file
+        struct RegionSlot {
+        public:
+            ui64 offset; ///< Byte offset of the blob, 0 if the slot is empty
+            ui32 compressedSize; ///< Bytes stored in the file
+            ui32 uncompressedSize; ///< Bytes after decompression, equal to compressedSize if stored raw
+        };
+
+        /// A file holding many chunks, each in a numbered slot
+        ///
+        /// The file starts with a header and an offset table of slotCount entries, followed by
+        /// compressed chunk blobs. Writes always append a new blob and then update the slot's
+        /// table entry, so a chunk is never left half-overwritten. The space of replaced blobs
+        /// is only reclaimed by compact(). Reads come straight from a memory mapping of the
+        /// file. Values are stored in native byte order. Not thread-safe.
+        class RegionFile {
+        public:
+            static const ui32 MAGIC = 0x4E475256; ///< "VRGN"
+            static const ui32 VERSION = 1;
+
+            RegionFile() {}
+            ~RegionFile() { close(); }
+            RegionFile(const RegionFile&) = delete;
+            RegionFile& operator=(const RegionFile&) = delete;
+
+            /// Open a region file, creating it if it doesn't exist
+            /// @param path: Path of the file
+            /// @param slotCount: Number of slots, must match the file's if it exists
+            /// @return True if the file was opened
+            bool open(const vio::Path& path, ui32 slotCount);
+            void close();
+
+            /// Compress and store a blob, replacing the slot's previous contents
+            /// @param slot: Slot index
+            /// @param data: Bytes to store
+            /// @param size: Number of bytes
+            /// @return True on success
+            bool write(ui32 slot, const void* data, size_t size);
+            /// Read and decompress a slot's blob
+            /// @param slot: Slot index
+            /// @param data: Receives the bytes
+            /// @return True if the slot holds a valid blob
+            bool read(ui32 slot, OUT std::vector<ui8>& data);
+            /// Empty a slot, its blob becomes wasted space
+            /// @return True on success
+            bool erase(ui32 slot);
+            /// @return True if the slot holds a blob
+            bool has(ui32 slot) const {
+                return slot < m_slots.size() && m_slots[slot].offset != 0;
+            }
+
+            /// Store the runs of an IntervalTree in a slot
+            template<typename T, typename S>
+            bool writeTree(ui32 slot, const IntervalTree<T, S>& tree);
+            /// Load an IntervalTree stored by writeTree
+            /// @return True if the slot held a valid tree, false for empty runs or lengths past MAX_LENGTH
+            template<typename T, typename S>
+            bool readTree(ui32 slot, OUT IntervalTree<T, S>& tree);
+
+            /// Rewrite the file with only live blobs, dropping wasted space
+            /// @return True on success, the file is unchanged on failure
+            bool compact();
+            /// Compact once the wasted space exceeds a fraction of the file
+            /// @param maxWaste: Fraction of the file that may be wasted
+            /// @return True if the file was compacted
+            bool compactIfNeeded(f32 maxWaste = 0.25f);
+
+            /// Getters
+            bool isOpen() const { return m_file != nullptr; }
+            ui32 getSlotCount() const { return (ui32)m_slots.size(); }
+            const ui64& getFileSize() const { return m_fileSize; }
+            /// @return Bytes held by replaced or erased blobs
+            ui64 getWastedBytes() const { return m_fileSize - getDataStart() - m_liveBytes; }
+        private:
+            struct Header {
+            public:
+                ui32 magic;
+                ui32 version;
+                ui32 slotCount;
+                ui32 reserved;
+            };
+
+            ui64 getDataStart() const {
+                return sizeof(Header) + m_slots.size() * sizeof(RegionSlot);
+            }
+            /// Write a slot's table entry
+            bool writeSlot(ui32 slot);
+
+            vio::Path m_path;
+            FILE* m_file = nullptr;
+            std::vector<RegionSlot> m_slots; ///< Offset table
+            ui64 m_fileSize = 0; ///< Bytes in the file
+            ui64 m_liveBytes = 0; ///< Bytes held by blobs referenced from the table
+
+            vio::MappedFile m_mapping; ///< Read-only view of the file, remapped when reads pass its end
+            std::vector<ui8> m_buffer; ///< Scratch space for (de)compression
+        };
+
+        template<typename T, typename S>
+        bool RegionFile::writeTree(ui32 slot, const IntervalTree<T, S>& tree) {
+            typedef typename IntervalTree<T, S>::LNode LNode;
+            std::vector<LNode> runs;
+            tree.gatherRuns(runs);
+
+            // Starts are implied by the lengths, so only {length, data} pairs are stored
+            const size_t RUN_SIZE = sizeof(S) + sizeof(T);
+            std::vector<ui8> bytes(runs.size() * RUN_SIZE);
+            for (size_t i = 0; i < runs.size(); i++) {
+                memcpy(&bytes[i * RUN_SIZE], &runs[i].length, sizeof(S));
+                memcpy(&bytes[i * RUN_SIZE + sizeof(S)], &runs[i].data, sizeof(T));
+            }
+            return write(slot, bytes.data(), bytes.size());
+        }
+
+        template<typename T, typename S>
+        bool RegionFile::readTree(ui32 slot, OUT IntervalTree<T, S>& tree) {
+            typedef typename IntervalTree<T, S>::LNode LNode;
+            std::vector<ui8> bytes;
+            if (!read(slot, bytes)) return false;
+
+            const size_t RUN_SIZE = sizeof(S) + sizeof(T);
+            if (bytes.size() % RUN_SIZE) return false;
+            std::vector<LNode> runs(bytes.size() / RUN_SIZE);
+            size_t start = 0;
+            for (size_t i = 0; i < runs.size(); i++) {
+                memcpy(&runs[i].length, &bytes[i * RUN_SIZE], sizeof(S));
+                memcpy(&runs[i].data, &bytes[i * RUN_SIZE + sizeof(S)], sizeof(T));
+                // Damaged runs must not reach the tree, whose starts would wrap into the color bit
+                if (runs[i].length == 0 || runs[i].length > IntervalTree<T, S>::MAX_LENGTH - start) return false;
+                runs[i].start = (S)start;
+                start += runs[i].length;
+            }
+            if (runs.empty()) {
+                tree.clear();
+            } else {
+                tree.initFromSortedArray(runs);
+            }
+            return true;
+        }
+    }
+}
+namespace vvox = vorb::voxel;
+
+#endif // !Vorb_RegionFile_h__
@@ -0,0 +1,285 @@
+//
+// VoxelLOD.h
+// Vorb Engine
+//
+// Created by the Vorb team on 18 Oct 2026
+// Copyright 2014 Regrowth Studios
+// MIT License
+//
+
+/*! \file VoxelLOD.h
+ * @brief Downsampling and meshing of voxel chunks at coarser levels of detail.
+ */
+
+#pragma once
+
+#ifndef Vorb_VoxelLOD_h__
+//! @cond DOXY_SHOW_HEADER_GUARDS
+#define Vorb_VoxelLOD_h__
+//! @endcond
+
+#ifndef VORB_USING_PCH
+#include <algorithm>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "../types.h"
+#endif // !VORB_USING_PCH
+
+#include "VoxelMeshAlg.h"
+#include "VoxelMesherGreedy.h"
+
+namespace vorb {
+    namespace voxel {
+        const ui32 MAX_LOD_LEVEL = 3; ///< Coarsest level, 8x downsampling
+
+        /// Combines a block of voxels into the most common non-empty voxel
+        ///
+        /// The block stays empty unless at least half of its samples are filled, which keeps
+        /// thin features from growing at coarse levels.
+        /// @tparam T: Voxel data type, must be equality comparable
+        template<typename T>
+        class MajorityVoxelCombine {
+        public:
+            MajorityVoxelCombine(const T& empty = T()) :
+                m_empty(empty) {
+                // Empty
+            }
+
+            T operator()(const T* samples, ui32 count) {
+                m_counts.clear();
+                ui32 filled = 0;
+                for (ui32 i = 0; i < count; i++) {
+                    if (samples[i] == m_empty) continue;
+                    filled++;
+                    size_t j = 0;
+                    while (j < m_counts.size() && !(m_counts[j].first == samples[i])) j++;
+                    if (j == m_counts.size()) m_counts.emplace_back(samples[i], 0);
+                    m_counts[j].second++;
+                }
+                if (filled * 2 < count) return m_empty;
+
+                size_t best = 0;
+                for (size_t j = 1; j < m_counts.size(); j++) {
+                    if (m_counts[j].second > m_counts[best].second) best = j;
+                }
+                return m_counts[best].first;
+            }
+        private:
+            T m_empty;
+            std::vector<std::pair<T, ui32> > m_counts; ///< Reused tally of distinct voxels
+        };
+
+        /// Downsample a chunk into a padded array ready for meshing
+        ///
+        /// Each output voxel combines a (2^level)^3 block of the source; blocks cut off by the
+        /// chunk edge only pass their existing samples. The one voxel border combines the
+        /// matching samples of the neighbour slices, so meshing only closes the chunk where
+        /// its neighbours are open. Sides without a neighbour use view.outside: an empty voxel
+        /// closes them with walls that act as skirts against neighbours meshed at a different
+        /// level, an opaque one leaves them open.
+        /// @tparam T: Voxel data type
+        /// @tparam Combine: Functor with T operator()(const T* samples, ui32 count)
+        /// @param view: Chunk data and neighbour slices
+        /// @param level: Level of detail in [1, MAX_LOD_LEVEL]
+        /// @param combine: Combine policy
+        /// @param result: Receives the padded voxels, accessed Y-Z-X
+        /// @return Sizes of the padded result (XYZ)
+        template<typename T, typename Combine>
+        ui32v3 downsampleChunk(const meshalg::ChunkView<T>& view, ui32 level, Combine& combine,
+                               OUT std::vector<T>& result) {
+            // In-plane axes of the neighbour slices, see ChunkView
+            static const ui32v2 SLICE_AXES[3] = {
+                ui32v2(1, 2),
+                ui32v2(2, 0),
+                ui32v2(1, 0)
+            };
+
+            const T* data = view.data;
+            const ui32v3& size = view.size;
+            ui32 factor = 1u << level;
+            ui32v3 reduced((size.x + factor - 1) / factor, (size.y + factor - 1) / factor, (size.z + factor - 1) / factor);
+            ui32v3 padded = reduced + ui32v3(2);
+            size_t l1 = size.x;
+            size_t l2 = l1 * size.z;
+            size_t p1 = padded.x;
+            size_t p2 = p1 * padded.z;
+
+            result.assign(p2 * padded.y, view.outside);
+            std::vector<T> samples;
+            samples.reserve(factor * factor * factor);
+            for (ui32 y = 0; y < reduced.y; y++) {
+                ui32 y1 = std::min((y + 1) * factor, size.y);
+                for (ui32 z = 0; z < reduced.z; z++) {
+                    ui32 z1 = std::min((z + 1) * factor, size.z);
+                    for (ui32 x = 0; x < reduced.x; x++) {
+                        ui32 x1 = std::min((x + 1) * factor, size.x);
+
+                        samples.clear();
+                        for (ui32 sy = y * factor; sy < y1; sy++) {
+                            for (ui32 sz = z * factor; sz < z1; sz++) {
+                                const T* row = data + sy * l2 + sz * l1;
+                                samples.insert(samples.end(), row + x * factor, row + x1);
+                            }
+                        }
+                        result[(y + 1) * p2 + (z + 1) * p1 + (x + 1)] = combine(samples.data(), (ui32)samples.size());
+                    }
+                }
+            }
+
+            // Border voxels combine the block of the neighbour slice they touch
+            for (size_t face = 0; face < 6; face++) {
+                const T* slice = view.neighbors[face];
+                if (!slice) continue;
+                size_t axis = face >> 1;
+                ui32 a = SLICE_AXES[axis].x;
+                ui32 b = SLICE_AXES[axis].y;
+                ui32v3 pos;
+                pos[axis] = (face & 1) ? padded[axis] - 1 : 0;
+                for (ui32 i = 0; i < reduced[a]; i++) {
+                    ui32 a1 = std::min((i + 1) * factor, size[a]);
+                    for (ui32 j = 0; j < reduced[b]; j++) {
+                        ui32 b1 = std::min((j + 1) * factor, size[b]);
+
+                        samples.clear();
+                        for (ui32 sa = i * factor; sa < a1; sa++) {
+                            const T* row = slice + (size_t)sa * size[b];
+                            samples.insert(samples.end(), row + j * factor, row + b1);
+                        }
+                        pos[a] = i + 1;
+                        pos[b] = j + 1;
+                        result[pos.y * p2 + pos.z * p1 + pos.x] = combine(samples.data(), (ui32)samples.size());
+                    }
+                }
+            }
+            return padded;
+        }
+
+        /// Caches downsampled chunks so they are only rebuilt when the source changes
+        ///
+        /// Callers pass a version that changes whenever a chunk's voxels or its neighbour
+        /// slices change (an edit counter covering the neighbours works). Not thread-safe.
+        /// @tparam T: Voxel data type
+        template<typename T>
+        class LODCache {
+        public:
+            /// A downsampled, padded chunk
+            struct Entry {
+            public:
+                ui64 version; ///< Source version the entry was built from
+                ui32v3 size; ///< Padded sizes (XYZ)
+                ui32v3 sourceSize; ///< Sizes of the source chunk (XYZ)
+                std::vector<T> data; ///< Padded voxels accessed Y-Z-X
+            };
+
+            /// Get a downsampled chunk, rebuilding it if the source version changed
+            /// @param chunkID: Unique chunk identifier, below 2^62
+            /// @param version: Version of the source data
+            /// @param level: Level of detail in [1, MAX_LOD_LEVEL]
+            /// @param view: Chunk data and neighbour slices, see downsampleChunk
+            /// @param combine: Combine policy
+            /// @return Cached entry, valid until the next call that rebuilds it or invalidate
+            template<typename Combine>
+            const Entry& get(ui64 chunkID, ui64 version, ui32 level, const meshalg::ChunkView<T>& view, Combine& combine) {
+                ui64 key = (chunkID << 2) | level;
+                auto it = m_entries.find(key);
+                if (it != m_entries.end() && it->second.version == version) return it->second;
+
+                Entry& entry = m_entries[key];
+                entry.version = version;
+                entry.sourceSize = view.size;
+                entry.size = downsampleChunk(view, level, combine, entry.data);
+                m_rebuilds++;
+                return entry;
+            }
+
+            /// Drop every level of a chunk, call when it unloads
+            void invalidate(ui64 chunkID) {
+                for (ui32 level = 1; level <= MAX_LOD_LEVEL; level++) {
+                    m_entries.erase((chunkID << 2) | level);
+                }
+            }
+            void clear() {
+                std::unordered_map<ui64, Entry>().swap(m_entries);
+            }
+
+            /// Getters
+            size_t getEntryCount() const { return m_entries.size(); }
+            const ui64& getRebuildCount() const { return m_rebuilds; }
+        private:
+            std::unordered_map<ui64, Entry> m_entries; ///< Keyed by (chunkID << 2) | level
+            ui64 m_rebuilds = 0; ///< Number of downsamples performed
+        };
+
+        namespace meshalg {
+            /// Forwards greedy meshing of a downsampled chunk, scaling quads to source voxels
+            template<typename API>
+            class LODMeshAPI {
+            public:
+                LODMeshAPI(API* api, ui32 level, const ui32v3& sourceSize) :
+                    m_api(api),
+                    m_factor(1u << level),
+                    m_sourceSize(sourceSize) {
+                    // Empty
+                }
+
+                template<typename T>
+                VoxelFaces occludes(const T& v1, const T& v2, const Axis& axis) {
+                    return m_api->occludes(v1, v2, axis);
+                }
+                template<typename T>
+                bool mergeable(const T& v1, const T& v2, const Cardinal& direction) {
+                    return m_api->mergeable(v1, v2, direction);
+                }
+                void result(const VoxelQuad& quad) {
+                    // In-plane axes of quad.size, see createGreedy
+                    static const ui32v2 PLANE_AXES[3] = {
+                        ui32v2(2, 1),
+                        ui32v2(0, 2),
+                        ui32v2(0, 1)
+                    };
+
+                    size_t axis = (size_t)quad.direction >> 1;
+                    ui32 u = PLANE_AXES[axis].x;
+                    ui32 v = PLANE_AXES[axis].y;
+                    ui32v3 start = (quad.voxelPosition - ui32v3(1)) * m_factor;
+
+                    VoxelQuad scaled = quad;
+                    scaled.voxelPosition = start;
+                    // Positive faces belong to the last source voxel of the block
+                    if ((size_t)quad.direction & 1) {
+                        scaled.voxelPosition[axis] = std::min(start[axis] + m_factor, m_sourceSize[axis]) - 1;
+                    }
+                    // Blocks cut off by the chunk edge only cover the voxels that exist
+                    scaled.size.x = std::min(start[u] + quad.size.x * m_factor, m_sourceSize[u]) - start[u];
+                    scaled.size.y = std::min(start[v] + quad.size.y * m_factor, m_sourceSize[v]) - start[v];
+                    m_api->result(scaled);
+                }
+            private:
+                API* m_api;
+                ui32 m_factor;
+                ui32v3 m_sourceSize;
+            };
+
+            /// Greedily mesh a downsampled chunk
+            ///
+            /// Uses the createGreedy API contract. Quad positions and sizes are scaled to the
+            /// source chunk's unpadded voxel coordinates and clipped to its extent, while
+            /// startIndex still indexes the downsampled data.
+            /// @param data: Padded voxels from LODCache or downsampleChunk
+            /// @param size: Padded sizes (XYZ)
+            /// @param sourceSize: Sizes of the source chunk (XYZ)
+            /// @param level: Level of detail the chunk was downsampled to
+            /// @param api: API object
+            template<typename T, typename API>
+            inline void createLOD(const T* data, const ui32v3& size, const ui32v3& sourceSize, ui32 level, API* api) {
+                LODMeshAPI<API> lodAPI(api, level, sourceSize);
+                createGreedy(data, size, &lodAPI);
+            }
+        }
+    }
+}
+namespace vvox = vorb::voxel;
+
+#endif // !Vorb_VoxelLOD_h__
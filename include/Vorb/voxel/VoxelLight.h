@@ -0,0 +1,275 @@
+//
+// VoxelLight.h
+// Vorb Engine
+//
+// Created by the Vorb team on 18 Oct 2026
+// Copyright 2014 Regrowth Studios
+// MIT License
+//
+
+/*! \file VoxelLight.h
+ * @brief Incremental flood-fill light propagation for voxel chunks.
+ */
+
+#pragma once
+
+#ifndef Vorb_VoxelLight_h__
+//! @cond DOXY_SHOW_HEADER_GUARDS
+#define Vorb_VoxelLight_h__
+//! @endcond
+
+#ifndef VORB_USING_PCH
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "../types.h"
+#endif // !VORB_USING_PCH
+
+#include "IntervalTree.h"
+
+namespace vorb {
+    namespace voxel {
+        const ui8 MAX_LIGHT_LEVEL = 15; ///< Brightest light level, each step loses one level
+
+        /// Light storage backed by a flat array of levels
+        ///
+        /// Blocks contract:
+        /// - bool isOpaque(size_t index) const
+        /// - ui8 getEmission(size_t index) const
+        /// @tparam Blocks: Block query type
+        template<typename Blocks>
+        class FlatLightStorage {
+        public:
+            /// @param light: Light levels accessed Y-Z-X
+            /// @param blocks: Block queries over the same indices
+            FlatLightStorage(ui8* light, const Blocks& blocks) :
+                m_light(light),
+                m_blocks(blocks) {
+                // Empty
+            }
+
+            ui8 getLight(size_t index) const { return m_light[index]; }
+            void setLight(size_t index, ui8 level) { m_light[index] = level; }
+            bool isOpaque(size_t index) const { return m_blocks.isOpaque(index); }
+            ui8 getEmission(size_t index) const { return m_blocks.getEmission(index); }
+        private:
+            ui8* m_light;
+            Blocks m_blocks;
+        };
+
+        /// Light storage backed by an IntervalTree of levels
+        ///
+        /// Writes are held in an overlay and applied to the tree in a single insertBatch by
+        /// flush(), so a propagation pass does not split runs one voxel at a time.
+        /// @tparam Blocks: Block query type, see FlatLightStorage
+        /// @tparam S: Width of the tree's runs
+        template<typename Blocks, typename S = ui16>
+        class IntervalTreeLightStorage {
+        public:
+            /// @param tree: Light levels accessed Y-Z-X
+            /// @param blocks: Block queries over the same indices
+            IntervalTreeLightStorage(IntervalTree<ui8, S>* tree, const Blocks& blocks) :
+                m_tree(tree),
+                m_blocks(blocks) {
+                // Empty
+            }
+
+            ui8 getLight(size_t index) {
+                auto it = m_pending.find(index);
+                if (it != m_pending.end()) return it->second;
+                return m_tree->getData(index);
+            }
+            void setLight(size_t index, ui8 level) { m_pending[index] = level; }
+            bool isOpaque(size_t index) const { return m_blocks.isOpaque(index); }
+            ui8 getEmission(size_t index) const { return m_blocks.getEmission(index); }
+
+            /// Write pending levels into the tree
+            void flush() {
+                if (m_pending.empty()) return;
+                std::vector<std::pair<size_t, ui8> > writes(m_pending.begin(), m_pending.end());
+                m_tree->insertBatch(writes);
+                m_pending.clear();
+            }
+
+            /// Getters
+            size_t getPendingWrites() const { return m_pending.size(); }
+        private:
+            IntervalTree<ui8, S>* m_tree;
+            Blocks m_blocks;
+            std::unordered_map<size_t, ui8> m_pending; ///< Levels not yet written to the tree
+        };
+
+        /// Flood-fill light propagation within a chunk
+        ///
+        /// Edits only touch the region whose light actually changes, so a single block edit
+        /// does not relight the chunk. Light does not cross the chunk border; seed border
+        /// voxels from neighbouring chunks with addLight.
+        ///
+        /// Storage contract:
+        /// - ui8 getLight(size_t index)
+        /// - void setLight(size_t index, ui8 level)
+        /// - bool isOpaque(size_t index)
+        /// - ui8 getEmission(size_t index)
+        class LightPropagator {
+        public:
+            /// @param size: Sizes of the chunk (XYZ), indices are accessed Y-Z-X
+            LightPropagator(const ui32v3& size) :
+                m_size(size),
+                m_l1(size.x),
+                m_l2((size_t)size.x * size.z) {
+                // Empty
+            }
+
+            /// Raise the light at a voxel and spread it
+            template<typename Storage>
+            void addLight(Storage& storage, const ui32v3& pos, ui8 level) {
+                size_t index = toIndex(pos);
+                if (storage.getLight(index) >= level) return;
+                storage.setLight(index, level);
+                m_addQueue.push_back(LightNode(pos, level));
+                propagateAdd(storage);
+            }
+            /// Remove the light at a voxel and everything that was lit through it
+            template<typename Storage>
+            void removeLight(Storage& storage, const ui32v3& pos) {
+                size_t index = toIndex(pos);
+                ui8 level = storage.getLight(index);
+                if (level == 0) return;
+                storage.setLight(index, 0);
+                m_removeQueue.push_back(LightNode(pos, level));
+                propagateRemove(storage);
+                propagateAdd(storage);
+            }
+
+            /// Update light after a block was placed, call once the block data has changed
+            template<typename Storage>
+            void onBlockPlaced(Storage& storage, const ui32v3& pos) {
+                removeLight(storage, pos);
+                ui8 emission = storage.getEmission(toIndex(pos));
+                if (emission) addLight(storage, pos, emission);
+            }
+            /// Update light after a block was removed, call once the block data has changed
+            template<typename Storage>
+            void onBlockRemoved(Storage& storage, const ui32v3& pos) {
+                removeLight(storage, pos);
+
+                // Let the neighbours shine into the opened voxel
+                ui32v3 neighbors[6];
+                size_t count = getNeighbors(pos, neighbors);
+                for (size_t i = 0; i < count; i++) {
+                    ui8 level = storage.getLight(toIndex(neighbors[i]));
+                    if (level > 1) m_addQueue.push_back(LightNode(neighbors[i], level));
+                }
+                propagateAdd(storage);
+            }
+
+            /// Light every emitting voxel of a chunk from scratch
+            template<typename Storage>
+            void relightAll(Storage& storage) {
+                ui32v3 pos;
+                for (pos.y = 0; pos.y < m_size.y; pos.y++) {
+                    for (pos.z = 0; pos.z < m_size.z; pos.z++) {
+                        for (pos.x = 0; pos.x < m_size.x; pos.x++) {
+                            size_t index = toIndex(pos);
+                            ui8 emission = storage.getEmission(index);
+                            if (emission && storage.getLight(index) < emission) {
+                                storage.setLight(index, emission);
+                                m_addQueue.push_back(LightNode(pos, emission));
+                            }
+                        }
+                    }
+                }
+                propagateAdd(storage);
+            }
+        private:
+            /// A queued voxel and the level it had when queued
+            struct LightNode {
+            public:
+                LightNode(const ui32v3& p, ui8 l) :
+                    x((ui16)p.x), y((ui16)p.y), z((ui16)p.z), level(l) {
+                    // Empty
+                }
+
+                ui32v3 position() const { return ui32v3(x, y, z); }
+
+                ui16 x;
+                ui16 y;
+                ui16 z;
+                ui8 level;
+            };
+
+            size_t toIndex(const ui32v3& pos) const {
+                return pos.y * m_l2 + pos.z * m_l1 + pos.x;
+            }
+            size_t getNeighbors(const ui32v3& pos, OUT ui32v3* neighbors) const {
+                size_t count = 0;
+                if (pos.x > 0) neighbors[count++] = ui32v3(pos.x - 1, pos.y, pos.z);
+                if (pos.x + 1 < m_size.x) neighbors[count++] = ui32v3(pos.x + 1, pos.y, pos.z);
+                if (pos.y > 0) neighbors[count++] = ui32v3(pos.x, pos.y - 1, pos.z);
+                if (pos.y + 1 < m_size.y) neighbors[count++] = ui32v3(pos.x, pos.y + 1, pos.z);
+                if (pos.z > 0) neighbors[count++] = ui32v3(pos.x, pos.y, pos.z - 1);
+                if (pos.z + 1 < m_size.z) neighbors[count++] = ui32v3(pos.x, pos.y, pos.z + 1);
+                return count;
+            }
+
+            /// Spread light breadth-first from the add queue
+            template<typename Storage>
+            void propagateAdd(Storage& storage) {
+                ui32v3 neighbors[6];
+                for (size_t head = 0; head < m_addQueue.size(); head++) {
+                    ui32v3 pos = m_addQueue[head].position();
+                    // Use the current level, the voxel may have been raised or cleared since
+                    ui8 level = storage.getLight(toIndex(pos));
+                    if (level <= 1) continue;
+
+                    size_t count = getNeighbors(pos, neighbors);
+                    for (size_t i = 0; i < count; i++) {
+                        size_t index = toIndex(neighbors[i]);
+                        if (storage.isOpaque(index) || storage.getLight(index) + 1 >= level) continue;
+                        storage.setLight(index, level - 1);
+                        m_addQueue.push_back(LightNode(neighbors[i], level - 1));
+                    }
+                }
+                m_addQueue.clear();
+            }
+            /// Clear light lit by removed voxels, queueing brighter neighbours to refill the hole
+            template<typename Storage>
+            void propagateRemove(Storage& storage) {
+                ui32v3 neighbors[6];
+                for (size_t head = 0; head < m_removeQueue.size(); head++) {
+                    LightNode node = m_removeQueue[head];
+                    size_t count = getNeighbors(node.position(), neighbors);
+                    for (size_t i = 0; i < count; i++) {
+                        size_t index = toIndex(neighbors[i]);
+                        ui8 level = storage.getLight(index);
+                        if (level == 0) continue;
+                        if (level < node.level) {
+                            storage.setLight(index, 0);
+                            m_removeQueue.push_back(LightNode(neighbors[i], level));
+
+                            // Emitters relight themselves
+                            ui8 emission = storage.getEmission(index);
+                            if (emission) {
+                                storage.setLight(index, emission);
+                                m_addQueue.push_back(LightNode(neighbors[i], emission));
+                            }
+                        } else {
+                            m_addQueue.push_back(LightNode(neighbors[i], level));
+                        }
+                    }
+                }
+                m_removeQueue.clear();
+            }
+
+            ui32v3 m_size; ///< Chunk sizes
+            size_t m_l1; ///< Index stride along z
+            size_t m_l2; ///< Index stride along y
+            std::vector<LightNode> m_addQueue; ///< Reused breadth-first queue of lit voxels
+            std::vector<LightNode> m_removeQueue; ///< Reused breadth-first queue of darkened voxels
+        };
+    }
+}
+namespace vvox = vorb::voxel;
+
+#endif // !Vorb_VoxelLight_h__
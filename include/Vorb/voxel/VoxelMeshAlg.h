@@ -19,6 +19,8 @@
 //! @endcond
 
 #ifndef VORB_USING_PCH
+#include <vector>
+
 #include "../types.h"
 #endif // !VORB_USING_PCH
 
@@ -43,7 +45,134 @@ namespace vorb {
                 Cardinal direction; ///< Direction the quad is facing
             };
 
+            /// A VoxelQuad packed into 8 bytes
+            ///
+            /// Bit layout, low to high: position x, y, z (6 bits each), direction (3 bits),
+            /// size.x - 1 and size.y - 1 (6 bits each), texture layer (16 bits) and
+            /// ambient occlusion (8 bits, as produced by computeFaceAO). Positions and sizes
+            /// must be below 64, which covers padded 62^3 chunks.
+            typedef ui64 PackedVoxelQuad;
+
+            const ui32 PACKED_POSITION_BITS = 6; ///< Bits per position component
+            const ui32 PACKED_DIRECTION_SHIFT = 18; ///< Offset of the direction
+            const ui32 PACKED_SIZE_SHIFT = 21; ///< Offset of the size
+            const ui32 PACKED_LAYER_SHIFT = 33; ///< Offset of the texture layer
+            const ui32 PACKED_AO_SHIFT = 49; ///< Offset of the ambient occlusion
+            const ui8 PACKED_AO_NONE = 0xFF; ///< Ambient occlusion of an unoccluded quad
+
+            /// Pack a quad
+            /// @param quad: Quad with position and size below 64
+            /// @param layer: Texture layer
+            /// @param ao: Packed corner occlusion
+            /// @return Packed quad
+            inline PackedVoxelQuad packQuad(const VoxelQuad& quad, ui16 layer, ui8 ao = PACKED_AO_NONE) {
+                return (ui64)(quad.voxelPosition.x & 63) |
+                    ((ui64)(quad.voxelPosition.y & 63) << 6) |
+                    ((ui64)(quad.voxelPosition.z & 63) << 12) |
+                    ((ui64)((ui32)quad.direction & 7) << PACKED_DIRECTION_SHIFT) |
+                    ((ui64)((quad.size.x - 1) & 63) << PACKED_SIZE_SHIFT) |
+                    ((ui64)((quad.size.y - 1) & 63) << (PACKED_SIZE_SHIFT + 6)) |
+                    ((ui64)layer << PACKED_LAYER_SHIFT) |
+                    ((ui64)ao << PACKED_AO_SHIFT);
+            }
+            inline ui32v3 getPackedPosition(PackedVoxelQuad quad) {
+                return ui32v3(quad & 63, (quad >> 6) & 63, (quad >> 12) & 63);
+            }
+            inline Cardinal getPackedDirection(PackedVoxelQuad quad) {
+                return (Cardinal)((quad >> PACKED_DIRECTION_SHIFT) & 7);
+            }
+            inline ui32v2 getPackedSize(PackedVoxelQuad quad) {
+                return ui32v2(((quad >> PACKED_SIZE_SHIFT) & 63) + 1, ((quad >> (PACKED_SIZE_SHIFT + 6)) & 63) + 1);
+            }
+            inline ui16 getPackedLayer(PackedVoxelQuad quad) {
+                return (ui16)(quad >> PACKED_LAYER_SHIFT);
+            }
+            inline ui8 getPackedAO(PackedVoxelQuad quad) {
+                return (ui8)(quad >> PACKED_AO_SHIFT);
+            }
+
+            /// Compute a corner of a packed quad, as a vertex shader expanding it would
+            ///
+            /// Corner i is offset by (i & 1) * size.x along the quad's first in-plane axis and
+            /// (i >> 1) * size.y along the second, matching generateQuadIndices.
+            /// @param quad: Packed quad
+            /// @param corner: Corner index [0, 3]
+            /// @return Corner position in voxel units, the face lies on the voxel's outer side
+            inline ui32v3 getPackedCorner(PackedVoxelQuad quad, ui32 corner) {
+                static const ui32v3 SWEEPS[3] = {
+                    ui32v3(0, 2, 1),
+                    ui32v3(1, 0, 2),
+                    ui32v3(2, 0, 1)
+                };
+                ui32 direction = (ui32)getPackedDirection(quad);
+                const ui32v3& sweep = SWEEPS[direction >> 1];
+                ui32v3 pos = getPackedPosition(quad);
+                ui32v2 size = getPackedSize(quad);
+                pos[sweep.x] += direction & 1;
+                pos[sweep.y] += (corner & 1) * size.x;
+                pos[sweep.z] += (corner >> 1) * size.y;
+                return pos;
+            }
+
+            /// Wraps a mesher API so that results are collected as packed quads
+            ///
+            /// The wrapped API keeps its meshing hooks and must also provide
+            /// ui16 getLayer(const VoxelQuad& quad). Results with ambient occlusion
+            /// (from createCulledAO) keep it, others are stored unoccluded.
+            /// @tparam API: Wrapped mesher API
+            template<typename API>
+            class PackedQuadCollector {
+            public:
+                /// @param api: Wrapped API
+                /// @param quads: Receives packed quads
+                PackedQuadCollector(API* api, std::vector<PackedVoxelQuad>* quads) :
+                    m_api(api),
+                    m_quads(quads) {
+                    // Empty
+                }
+
+                template<typename T>
+                VoxelFaces occludes(const T& v1, const T& v2, const Axis& axis) {
+                    return m_api->occludes(v1, v2, axis);
+                }
+                template<typename T>
+                bool mergeable(const T& v1, const T& v2, const Cardinal& direction) {
+                    return m_api->mergeable(v1, v2, direction);
+                }
+                template<typename T>
+                bool isOpaque(const T& v) {
+                    return m_api->isOpaque(v);
+                }
+                void result(const VoxelQuad& quad) {
+                    m_quads->push_back(packQuad(quad, m_api->getLayer(quad)));
+                }
+                void result(const VoxelQuad& quad, ui8 ao) {
+                    m_quads->push_back(packQuad(quad, m_api->getLayer(quad), ao));
+                }
+            private:
+                API* m_api;
+                std::vector<PackedVoxelQuad>* m_quads;
+            };
+
+            /// An unpadded chunk of voxels with the neighbouring voxel layers around it
+            ///
+            /// Neighbour slices are the layer of the adjacent chunk that touches this one,
+            /// indexed by Cardinal and laid out like the chunk data with the face axis dropped:
+            /// X slices are accessed [y * size.z + z], Y slices [z * size.x + x] and
+            /// Z slices [y * size.x + x].
+            /// @tparam T: Voxel data type
+            template<typename T>
+            struct ChunkView {
+            public:
+                const T* data = nullptr; ///< 3D array of voxel data accessed Y-Z-X
+                ui32v3 size; ///< Sizes of the chunk (XYZ)
+                const T* neighbors[6] = {}; ///< Adjacent voxel slices, null when there is no neighbour
+                T outside = T(); ///< Voxel used in place of a missing neighbour slice
+            };
+
             /// Create an index list for quads
+            ///
+            /// The pattern is the same for every mesh, prefer SharedQuadIndices over a copy per mesh.
             /// @tparam T: Index type/size
             /// @param quads: Number of quads for which indices must be specified
             /// @param startIndex: The index of the first vertex
@@ -64,6 +193,54 @@ namespace vorb {
                 }
                 return inds;
             }
+
+            const ui32 MAX_QUADS_INDEX16 = 16384; ///< Most quads addressable by 16-bit indices
+
+            /// Create a 16-bit index list for quads drawn in batches
+            ///
+            /// Meshes with more than MAX_QUADS_INDEX16 quads are drawn in batches of that many
+            /// quads, each offset by a base vertex of batch * MAX_QUADS_INDEX16 * 4, so one list
+            /// serves every mesh.
+            /// @param quads: Number of quads in the largest mesh
+            /// @return Array of min(quads, MAX_QUADS_INDEX16) * 6 indices
+            inline CALLER_DELETE ui16* generateQuadIndices16(const ui32& quads) {
+                return generateQuadIndices<ui16>(quads < MAX_QUADS_INDEX16 ? quads : MAX_QUADS_INDEX16);
+            }
+            /// Process-wide quad index patterns shared by every mesh
+            ///
+            /// Patterns grow by doubling and are never freed, so a returned array stays valid
+            /// for the lifetime of the process and only needs to be fetched again when a mesh
+            /// needs more quads. CPU access is thread-safe; GPU buffers must be requested from
+            /// the thread that owns the GL context.
+            class SharedQuadIndices {
+            public:
+                /// @param quads: Number of quads to index, at most MAX_QUADS_INDEX16
+                /// @return Pattern of at least quads * 6 16-bit indices, nullptr if quads is too large
+                static const ui16* get16(ui32 quads);
+                /// @param quads: Number of quads to index, at most 2^27
+                /// @return Pattern of at least quads * 6 32-bit indices, nullptr if quads is too large
+                static const ui32* get32(ui32 quads);
+
+                /// Get an element buffer holding the 16-bit pattern
+                ///
+                /// The buffer keeps its ID when it grows, so vertex arrays referencing it stay
+                /// valid. Growing keeps the bound vertex array and its index buffer.
+                /// @param quads: Number of quads to index, at most MAX_QUADS_INDEX16
+                /// @return VGIndexBuffer of at least quads * 6 indices, 0 if quads is too large
+                static ui32 getBuffer16(ui32 quads);
+                /// Get an element buffer holding the 32-bit pattern, see getBuffer16
+                /// @param quads: Number of quads to index, at most 2^27
+                /// @return VGIndexBuffer of at least quads * 6 indices, 0 if quads is too large
+                static ui32 getBuffer32(ui32 quads);
+                /// Free the GPU buffers, call before the GL context is destroyed
+                static void freeBuffers();
+            };
+
+            /// @param quads: Number of quads in a mesh
+            /// @return Number of draw batches needed with generateQuadIndices16
+            inline ui32 getQuadIndexBatches16(const ui32& quads) {
+                return (quads + MAX_QUADS_INDEX16 - 1) / MAX_QUADS_INDEX16;
+            }
         }
     }
 }
@@ -19,12 +19,18 @@
 //! @endcond
 
 #ifndef VORB_USING_PCH
+#include <vector>
+
 #include "../types.h"
 #endif // !VORB_USING_PCH
 
 #include "VoxCommon.h"
 #include "VoxelMeshAlg.h"
 
+#if defined(VORB_COMPILER_MSVC)
+#include <intrin.h>
+#endif
+
 namespace vorb {
     namespace voxel {
         namespace meshalg {
@@ -83,6 +89,326 @@ namespace vorb {
                     }
                 }
             }
+
+            /// Compute ambient occlusion for the four corners of a face
+            ///
+            /// Corner i lies at (i & 1, i >> 1) along the face's (u, v) axes, matching the vertex
+            /// order of generateQuadIndices. Each corner gets 2 bits, 3 being fully lit.
+            /// @param opaque: Opacity flags of the voxel array
+            /// @param base: Index of the voxel in front of the face
+            /// @param uStride: Index offset of one step along u
+            /// @param vStride: Index offset of one step along v
+            /// @return Packed corner values, corner i in bits [2i, 2i + 1]
+            inline ui8 computeFaceAO(const ui8* opaque, size_t base, size_t uStride, size_t vStride) {
+                const ui8* center = opaque + base;
+                ui8 ao = 0;
+                for (ui32 i = 0; i < 4; i++) {
+                    const ui8* side1 = (i & 1) ? center + uStride : center - uStride;
+                    const ui8* side2 = (i & 2) ? center + vStride : center - vStride;
+                    ui8 s1 = *side1;
+                    ui8 s2 = *side2;
+                    ui8 corner = *(side1 + (side2 - center));
+                    ui8 value = (s1 && s2) ? 0 : (ui8)(3 - (s1 + s2 + corner));
+                    ao |= value << (i * 2);
+                }
+                return ao;
+            }
+            /// Extract a corner from packed ambient occlusion
+            /// @param ao: Packed value from computeFaceAO
+            /// @param corner: Corner index [0, 3]
+            /// @return Occlusion level, 0 is darkest and 3 is unoccluded
+            inline ui8 getCornerAO(ui8 ao, ui32 corner) {
+                return (ao >> (corner * 2)) & 3;
+            }
+
+            /// Construct a culled voxel mesh with per-vertex ambient occlusion
+            ///
+            /// Opacity is queried once per voxel into a flag array, which the sweep then reuses to
+            /// occlude face corners instead of re-reading neighbour voxels per quad.
+            ///
+            /// API contract:
+            /// - VoxelFaces occludes(const T& v1, const T& v2, const Axis& axis)
+            /// - bool isOpaque(const T& v)
+            /// - void result(const VoxelQuad& quad, ui8 ao)
+            /// @tparam T: Voxel data type
+            /// @tparam API: Type of API object that handles culled meshing
+            /// @param data: 3D array of voxel data accessed Y-Z-X, with a one voxel border
+            /// @param size: Sizes of array (XYZ)
+            /// @param api: API object
+            template<typename T, typename API>
+            inline void createCulledAO(const T* data, const ui32v3& size, API* api) {
+                static ui32v3 SWEEPS[3] = {
+                    ui32v3(0, 2, 1),
+                    ui32v3(1, 0, 2),
+                    ui32v3(2, 0, 1)
+                };
+                static Axis AXES[3] = {
+                    Axis::X,
+                    Axis::Y,
+                    Axis::Z
+                };
+
+                ui32v3 pos;
+                size_t l1 = size.x;
+                size_t l2 = l1 * size.z;
+                size_t strides[3] = { 1, l2, l1 };
+
+                std::vector<ui8> opaque(l2 * size.y);
+                for (size_t i = 0; i < opaque.size(); i++) {
+                    opaque[i] = api->isOpaque(data[i]) ? 1 : 0;
+                }
+
+                for (size_t axis = 0; axis < 3; axis++) {
+                    ui32& fAxis = pos[SWEEPS[axis].x];
+                    ui32& uAxis = pos[SWEEPS[axis].y];
+                    ui32& vAxis = pos[SWEEPS[axis].z];
+                    ui32v3 sizes(size[SWEEPS[axis].x], size[SWEEPS[axis].y], size[SWEEPS[axis].z]);
+                    size_t fStride = strides[SWEEPS[axis].x];
+                    size_t uStride = strides[SWEEPS[axis].y];
+                    size_t vStride = strides[SWEEPS[axis].z];
+
+                    VoxelQuad qNeg, qPos;
+                    qPos.direction = toCardinal(AXES[axis], true);
+                    qNeg.direction = toCardinal(AXES[axis], false);
+                    qNeg.size = qPos.size = ui32v2(1, 1);
+
+                    for (fAxis = 1; fAxis < sizes.x; fAxis++) {
+                        for (uAxis = 1; uAxis < sizes.y - 1; uAxis++) {
+                            for (vAxis = 1; vAxis < sizes.z - 1; vAxis++) {
+                                fAxis--;
+                                qPos.voxelPosition = pos;
+                                qPos.startIndex = pos.y * l2 + pos.z * l1 + pos.x;
+                                const T& v1 = data[qPos.startIndex];
+
+                                fAxis++;
+                                qNeg.voxelPosition = pos;
+                                qNeg.startIndex = pos.y * l2 + pos.z * l1 + pos.x;
+                                const T& v2 = data[qNeg.startIndex];
+
+                                // Faces are shaded by the layer they look into
+                                VoxelFaces f = api->occludes(v1, v2, AXES[axis]);
+                                if (f.block1Face && fAxis != 1) {
+                                    api->result(qPos, computeFaceAO(&opaque[0], qPos.startIndex + fStride, uStride, vStride));
+                                }
+                                if (f.block2Face && fAxis != sizes.x - 1) {
+                                    api->result(qNeg, computeFaceAO(&opaque[0], qNeg.startIndex - fStride, uStride, vStride));
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+
+            /// Construct a voxel mesh from an unpadded chunk and its neighbour slices
+            ///
+            /// Uses the same API contract as createCulled but meshes every voxel of the chunk,
+            /// comparing border voxels against the neighbour slices instead of a padded copy.
+            /// Quad positions and start indices are in the chunk's own (unpadded) coordinates.
+            /// @tparam T: Voxel data type
+            /// @tparam API: Type of API object that handles culled meshing
+            /// @param view: Chunk data and neighbour slices
+            /// @param api: API object
+            template<typename T, typename API>
+            inline void createCulled(const ChunkView<T>& view, API* api) {
+                static ui32v3 SWEEPS[3] = {
+                    ui32v3(0, 2, 1),
+                    ui32v3(1, 0, 2),
+                    ui32v3(2, 0, 1)
+                };
+                static Axis AXES[3] = {
+                    Axis::X,
+                    Axis::Y,
+                    Axis::Z
+                };
+
+                const T* data = view.data;
+                const ui32v3& size = view.size;
+                ui32v3 pos;
+                size_t l1 = size.x;
+                size_t l2 = l1 * size.z;
+
+                for (size_t axis = 0; axis < 3; axis++) {
+                    ui32& fAxis = pos[SWEEPS[axis].x];
+                    ui32& uAxis = pos[SWEEPS[axis].y];
+                    ui32& vAxis = pos[SWEEPS[axis].z];
+                    ui32v3 sizes(size[SWEEPS[axis].x], size[SWEEPS[axis].y], size[SWEEPS[axis].z]);
+                    if (sizes.x == 0) continue;
+
+                    VoxelQuad qNeg, qPos;
+                    qPos.direction = toCardinal(AXES[axis], true);
+                    qNeg.direction = toCardinal(AXES[axis], false);
+                    qNeg.size = qPos.size = ui32v2(1, 1);
+
+                    const T* negSlice = view.neighbors[(size_t)qNeg.direction];
+                    const T* posSlice = view.neighbors[(size_t)qPos.direction];
+
+                    // Pairs (f - 1, f), where -1 and sizes.x are the neighbour slices
+                    for (ui32 f = 0; f <= sizes.x; f++) {
+                        bool hasFirst = f != 0;
+                        bool hasSecond = f != sizes.x;
+                        for (uAxis = 0; uAxis < sizes.y; uAxis++) {
+                            for (vAxis = 0; vAxis < sizes.z; vAxis++) {
+                                size_t sliceIndex = vAxis * sizes.y + uAxis;
+
+                                const T* v1;
+                                if (hasFirst) {
+                                    fAxis = f - 1;
+                                    qPos.voxelPosition = pos;
+                                    qPos.startIndex = (ui32)(pos.y * l2 + pos.z * l1 + pos.x);
+                                    v1 = data + qPos.startIndex;
+                                } else {
+                                    v1 = negSlice ? negSlice + sliceIndex : &view.outside;
+                                }
+
+                                const T* v2;
+                                if (hasSecond) {
+                                    fAxis = f;
+                                    qNeg.voxelPosition = pos;
+                                    qNeg.startIndex = (ui32)(pos.y * l2 + pos.z * l1 + pos.x);
+                                    v2 = data + qNeg.startIndex;
+                                } else {
+                                    v2 = posSlice ? posSlice + sliceIndex : &view.outside;
+                                }
+
+                                VoxelFaces faces = api->occludes(*v1, *v2, AXES[axis]);
+                                if (faces.block1Face && hasFirst) api->result(qPos);
+                                if (faces.block2Face && hasSecond) api->result(qNeg);
+                            }
+                        }
+                    }
+                }
+            }
+
+            /// @return Index of the lowest set bit, v may not be 0
+            inline ui32 lowestBit(ui64 v) {
+#if defined(VORB_COMPILER_MSVC) && defined(VORB_ARCH_64)
+                unsigned long i;
+                _BitScanForward64(&i, v);
+                return (ui32)i;
+#elif defined(VORB_COMPILER_MSVC)
+                unsigned long i;
+                if (_BitScanForward(&i, (ui32)v)) return (ui32)i;
+                _BitScanForward(&i, (ui32)(v >> 32));
+                return (ui32)i + 32;
+#else
+                return (ui32)__builtin_ctzll(v);
+#endif
+            }
+
+            /// Construct a culled voxel mesh from per-voxel opacity using column bitmasks
+            ///
+            /// Produces the same quads as createCulled with an API whose occludes() reports a
+            /// face when an opaque voxel touches a non-opaque one, though in a different order.
+            /// Opacity is queried once per voxel and packed into 64-bit columns along each
+            /// axis, so a whole column of faces is found with two shifts and AND-NOTs.
+            /// Translucent voxels that need pairwise rules should use createCulled instead.
+            ///
+            /// API contract:
+            /// - bool isOpaque(const T& v)
+            /// - void result(const VoxelQuad& quad)
+            /// @tparam T: Voxel data type
+            /// @tparam API: Type of API object that handles masked meshing
+            /// @param data: 3D array of voxel data accessed Y-Z-X, with a one voxel border
+            /// @param size: Sizes of array (XYZ), larger than 64 falls back to a createCulled sweep
+            /// @param api: API object
+            template<typename T, typename API>
+            inline void createCulledMasked(const T* data, const ui32v3& size, API* api) {
+                static ui32v3 SWEEPS[3] = {
+                    ui32v3(0, 2, 1),
+                    ui32v3(1, 0, 2),
+                    ui32v3(2, 0, 1)
+                };
+                static Axis AXES[3] = {
+                    Axis::X,
+                    Axis::Y,
+                    Axis::Z
+                };
+                if (size.x > 64 || size.y > 64 || size.z > 64) {
+                    // Columns no longer fit a word, so cull pair by pair with the same rule
+                    struct OpacityAPI {
+                    public:
+                        VoxelFaces occludes(const T& v1, const T& v2, const Axis& axis VORB_UNUSED) {
+                            bool opaque1 = api->isOpaque(v1);
+                            bool opaque2 = api->isOpaque(v2);
+                            VoxelFaces faces;
+                            faces.block1Face = opaque1 && !opaque2;
+                            faces.block2Face = opaque2 && !opaque1;
+                            return faces;
+                        }
+                        void result(const VoxelQuad& quad) {
+                            api->result(quad);
+                        }
+
+                        API* api;
+                    };
+                    OpacityAPI opacityAPI;
+                    opacityAPI.api = api;
+                    createCulled(data, size, &opacityAPI);
+                    return;
+                }
+
+                size_t l1 = size.x;
+                size_t l2 = l1 * size.z;
+
+                // Opacity columns, indexed [u * vSize + v] with bit f set for an opaque voxel
+                std::vector<ui64> columns[3];
+                columns[0].assign(size.z * size.y, 0);
+                columns[1].assign(size.x * size.z, 0);
+                columns[2].assign(size.x * size.y, 0);
+                for (ui32 y = 0; y < size.y; y++) {
+                    for (ui32 z = 0; z < size.z; z++) {
+                        const T* row = data + y * l2 + z * l1;
+                        ui64 rowMask = 0;
+                        for (ui32 x = 0; x < size.x; x++) {
+                            ui64 opaque = api->isOpaque(row[x]) ? 1 : 0;
+                            rowMask |= opaque << x;
+                            columns[1][x * size.z + z] |= opaque << y;
+                            columns[2][x * size.y + y] |= opaque << z;
+                        }
+                        columns[0][z * size.y + y] = rowMask;
+                    }
+                }
+
+                ui32v3 pos;
+                for (size_t axis = 0; axis < 3; axis++) {
+                    ui32& fAxis = pos[SWEEPS[axis].x];
+                    ui32& uAxis = pos[SWEEPS[axis].y];
+                    ui32& vAxis = pos[SWEEPS[axis].z];
+                    ui32v3 sizes(size[SWEEPS[axis].x], size[SWEEPS[axis].y], size[SWEEPS[axis].z]);
+                    if (sizes.x < 3) continue;
+
+                    VoxelQuad qNeg, qPos;
+                    qPos.direction = toCardinal(AXES[axis], true);
+                    qNeg.direction = toCardinal(AXES[axis], false);
+                    qNeg.size = qPos.size = ui32v2(1, 1);
+
+                    // Faces of the border voxels belong to neighbouring meshes
+                    ui64 interior = ((((ui64)1) << (sizes.x - 1)) - 1) & ~((ui64)1);
+
+                    for (uAxis = 1; uAxis < sizes.y - 1; uAxis++) {
+                        for (vAxis = 1; vAxis < sizes.z - 1; vAxis++) {
+                            ui64 column = columns[axis][uAxis * sizes.z + vAxis];
+                            ui64 posFaces = column & ~(column >> 1) & interior;
+                            ui64 negFaces = column & ~(column << 1) & interior;
+
+                            while (posFaces) {
+                                fAxis = lowestBit(posFaces);
+                                posFaces &= posFaces - 1;
+                                qPos.voxelPosition = pos;
+                                qPos.startIndex = (ui32)(pos.y * l2 + pos.z * l1 + pos.x);
+                                api->result(qPos);
+                            }
+                            while (negFaces) {
+                                fAxis = lowestBit(negFaces);
+                                negFaces &= negFaces - 1;
+                                qNeg.voxelPosition = pos;
+                                qNeg.startIndex = (ui32)(pos.y * l2 + pos.z * l1 + pos.x);
+                                api->result(qNeg);
+                            }
+                        }
+                    }
+                }
+            }
         }
     }
 }
@@ -0,0 +1,179 @@
+//
+// VoxelMesherGreedy.h
+// Vorb Engine
+//
+// Created by the Vorb team on 18 Oct 2026
+// Copyright 2014 Regrowth Studios
+// MIT License
+//
+
+/*! \file VoxelMesherGreedy.h
+ * @brief Greedy voxel meshing that merges coplanar faces into rectangles.
+ */
+
+#pragma once
+
+#ifndef Vorb_VoxelMesherGreedy_h__
+//! @cond DOXY_SHOW_HEADER_GUARDS
+#define Vorb_VoxelMesherGreedy_h__
+//! @endcond
+
+#ifndef VORB_USING_PCH
+#include <vector>
+
+#include "../types.h"
+#endif // !VORB_USING_PCH
+
+#include "VoxCommon.h"
+#include "VoxelMeshAlg.h"
+
+namespace vorb {
+    namespace voxel {
+        namespace meshalg {
+            const ui32 GREEDY_NO_FACE = 0xFFFFFFFFu; ///< Empty cell in a greedy face mask
+
+            /// Merge a face mask of one slice into maximal rectangles
+            /// @tparam T: Voxel data type
+            /// @tparam API: Type of API object that handles greedy meshing
+            /// @param data: 3D array of voxel data accessed Y-Z-X
+            /// @param mask: Voxel indices of visible faces (u-major), cleared while merging
+            /// @param uSize: Height of the mask
+            /// @param vSize: Width of the mask
+            /// @param pos: Position vector whose u and v components are written
+            /// @param uAxis: Component of pos along the mask height
+            /// @param vAxis: Component of pos along the mask width
+            /// @param quad: Quad with direction preset, sent to api->result
+            /// @param api: API object
+            template<typename T, typename API>
+            inline void mergeGreedyMask(const T* data, ui32* mask, ui32 uSize, ui32 vSize,
+                                        ui32v3& pos, ui32& uAxis, ui32& vAxis, VoxelQuad& quad, API* api) {
+                for (ui32 u = 0; u < uSize; u++) {
+                    for (ui32 v = 0; v < vSize; v++) {
+                        ui32 index = mask[u * vSize + v];
+                        if (index == GREEDY_NO_FACE) continue;
+                        const T& voxel = data[index];
+
+                        // Grow along v
+                        ui32 width = 1;
+                        while (v + width < vSize) {
+                            ui32 other = mask[u * vSize + v + width];
+                            if (other == GREEDY_NO_FACE || !api->mergeable(voxel, data[other], quad.direction)) break;
+                            width++;
+                        }
+
+                        // Grow along u while the whole next row can merge
+                        ui32 height = 1;
+                        while (u + height < uSize) {
+                            ui32* row = mask + (u + height) * vSize + v;
+                            bool rowFits = true;
+                            for (ui32 w = 0; w < width; w++) {
+                                if (row[w] == GREEDY_NO_FACE || !api->mergeable(voxel, data[row[w]], quad.direction)) {
+                                    rowFits = false;
+                                    break;
+                                }
+                            }
+                            if (!rowFits) break;
+                            height++;
+                        }
+
+                        // Consume the rectangle
+                        for (ui32 h = 0; h < height; h++) {
+                            ui32* row = mask + (u + h) * vSize + v;
+                            for (ui32 w = 0; w < width; w++) row[w] = GREEDY_NO_FACE;
+                        }
+
+                        uAxis = u + 1;
+                        vAxis = v + 1;
+                        quad.voxelPosition = pos;
+                        quad.startIndex = index;
+                        quad.size = ui32v2(height, width);
+                        api->result(quad);
+                    }
+                }
+            }
+
+            /// Construct a voxel mesh, merging culled faces into maximal rectangles per slice
+            ///
+            /// Uses the same API contract as createCulled, plus a merge hook:
+            /// - VoxelFaces occludes(const T& v1, const T& v2, const Axis& axis)
+            /// - bool mergeable(const T& v1, const T& v2, const Cardinal& direction)
+            /// - void result(const VoxelQuad& quad)
+            ///
+            /// Quads start at their lowest voxel. size.x spans the sweep's first in-plane
+            /// axis and size.y the second, which are (Z, Y) for X faces, (X, Z) for Y faces
+            /// and (X, Y) for Z faces.
+            /// @tparam T: Voxel data type
+            /// @tparam API: Type of API object that handles greedy meshing
+            /// @param data: 3D array of voxel data accessed Y-Z-X, with a one voxel border
+            /// @param size: Sizes of array (XYZ)
+            /// @param api: API object
+            template<typename T, typename API>
+            inline void createGreedy(const T* data, const ui32v3& size, API* api) {
+                static ui32v3 SWEEPS[3] = {
+                    ui32v3(0, 2, 1),
+                    ui32v3(1, 0, 2),
+                    ui32v3(2, 0, 1)
+                };
+                static Axis AXES[3] = {
+                    Axis::X,
+                    Axis::Y,
+                    Axis::Z
+                };
+
+                ui32v3 pos;
+                size_t l1 = size.x;
+                size_t l2 = l1 * size.z;
+
+                std::vector<ui32> posMask, negMask;
+                for (size_t axis = 0; axis < 3; axis++) {
+                    ui32& fAxis = pos[SWEEPS[axis].x];
+                    ui32& uAxis = pos[SWEEPS[axis].y];
+                    ui32& vAxis = pos[SWEEPS[axis].z];
+                    ui32v3 sizes(size[SWEEPS[axis].x], size[SWEEPS[axis].y], size[SWEEPS[axis].z]);
+                    if (sizes.y < 3 || sizes.z < 3) continue;
+                    ui32 uSize = sizes.y - 2;
+                    ui32 vSize = sizes.z - 2;
+                    posMask.resize(uSize * vSize);
+                    negMask.resize(uSize * vSize);
+
+                    VoxelQuad qNeg, qPos;
+                    qPos.direction = toCardinal(AXES[axis], true);
+                    qNeg.direction = toCardinal(AXES[axis], false);
+
+                    for (ui32 f = 1; f < sizes.x; f++) {
+                        // Gather visible faces between slices f - 1 and f
+                        bool hasPos = false, hasNeg = false;
+                        for (uAxis = 1; uAxis < sizes.y - 1; uAxis++) {
+                            for (vAxis = 1; vAxis < sizes.z - 1; vAxis++) {
+                                size_t m = (uAxis - 1) * vSize + (vAxis - 1);
+
+                                fAxis = f - 1;
+                                ui32 i1 = (ui32)(pos.y * l2 + pos.z * l1 + pos.x);
+                                fAxis = f;
+                                ui32 i2 = (ui32)(pos.y * l2 + pos.z * l1 + pos.x);
+
+                                VoxelFaces faces = api->occludes(data[i1], data[i2], AXES[axis]);
+                                posMask[m] = (faces.block1Face && f != 1) ? i1 : GREEDY_NO_FACE;
+                                negMask[m] = (faces.block2Face && f != sizes.x - 1) ? i2 : GREEDY_NO_FACE;
+                                hasPos |= posMask[m] != GREEDY_NO_FACE;
+                                hasNeg |= negMask[m] != GREEDY_NO_FACE;
+                            }
+                        }
+
+                        if (hasPos) {
+                            fAxis = f - 1;
+                            mergeGreedyMask(data, &posMask[0], uSize, vSize, pos, uAxis, vAxis, qPos, api);
+                        }
+                        if (hasNeg) {
+                            fAxis = f;
+                            mergeGreedyMask(data, &negMask[0], uSize, vSize, pos, uAxis, vAxis, qNeg, api);
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+namespace vvox = vorb::voxel;
+
+#endif // !Vorb_VoxelMesherGreedy_h__
@@ -0,0 +1,209 @@
+//
+// VoxelRaycast.h
+// Vorb Engine
+//
+// Created by the Vorb team on 18 Oct 2026
+// Copyright 2014 Regrowth Studios
+// MIT License
+//
+
+/*! \file VoxelRaycast.h
+ * @brief Voxel DDA raycasts over flat and run-length compressed chunks.
+ */
+
+#pragma once
+
+#ifndef Vorb_VoxelRaycast_h__
+//! @cond DOXY_SHOW_HEADER_GUARDS
+#define Vorb_VoxelRaycast_h__
+//! @endcond
+
+#ifndef VORB_USING_PCH
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "../types.h"
+#endif // !VORB_USING_PCH
+
+#include "IntervalTree.h"
+#include "VoxCommon.h"
+
+namespace vorb {
+    namespace voxel {
+        /// A ray in chunk-local voxel units, voxel (x, y, z) covers [x, x + 1) on each axis
+        struct VoxelRay {
+        public:
+            f32v3 origin; ///< Start of the ray
+            f32v3 direction; ///< Normalized direction of the ray
+            f32 maxDistance; ///< Distance after which the ray misses
+        };
+
+        /// Outcome of a raycast
+        struct VoxelRaycastResult {
+        public:
+            bool hit = false; ///< True if the ray hit a solid voxel
+            ui32v3 voxel; ///< Position of the hit voxel
+            Cardinal face = Cardinal::X_NEG; ///< Face of the hit voxel the ray entered through, unset at distance 0
+            f32 distance = 0.0f; ///< Distance along the ray to the hit
+        };
+
+        /// Solid queries over a flat array of voxels accessed Y-Z-X
+        ///
+        /// IsSolid contract: bool operator()(const T& v) const
+        template<typename T, typename IsSolid>
+        class FlatRaycastAccessor {
+        public:
+            FlatRaycastAccessor(const T* data, const ui32v3& size, const IsSolid& isSolid) :
+                m_data(data),
+                m_size(size),
+                m_isSolid(isSolid) {
+                // Empty
+            }
+
+            /// @return True if the voxel is solid
+            bool query(const ui32v3& voxel, OUT ui32& runStart, OUT ui32& runEnd) const {
+                runStart = voxel.x;
+                runEnd = voxel.x + 1;
+                return m_isSolid(m_data[((size_t)voxel.y * m_size.z + voxel.z) * m_size.x + voxel.x]);
+            }
+        private:
+            const T* m_data;
+            ui32v3 m_size;
+            IsSolid m_isSolid;
+        };
+
+        /// Solid queries over an IntervalTree of voxels accessed Y-Z-X
+        ///
+        /// Each query returns the whole run around the voxel within its row, so the raycast
+        /// can cross it without further lookups. Call updateLookup() on the tree before a
+        /// batch of rays for the fastest queries.
+        template<typename T, typename S, typename IsSolid>
+        class IntervalTreeRaycastAccessor {
+        public:
+            IntervalTreeRaycastAccessor(const IntervalTree<T, S>* tree, const ui32v3& size, const IsSolid& isSolid) :
+                m_tree(tree),
+                m_size(size),
+                m_isSolid(isSolid) {
+                // Empty
+            }
+
+            /// @return True if the voxel is solid
+            bool query(const ui32v3& voxel, OUT ui32& runStart, OUT ui32& runEnd) const {
+                size_t row = ((size_t)voxel.y * m_size.z + voxel.z) * m_size.x;
+                size_t start, end;
+                const T& data = m_tree->getRun(row + voxel.x, start, end);
+                runStart = (ui32)(std::max(start, row) - row);
+                runEnd = (ui32)(std::min(end, row + m_size.x) - row);
+                return m_isSolid(data);
+            }
+        private:
+            const IntervalTree<T, S>* m_tree;
+            ui32v3 m_size;
+            IsSolid m_isSolid;
+        };
+
+        /// Cast a ray through a chunk with a voxel DDA
+        ///
+        /// Rays starting outside the chunk are clipped to it first. Within a run of non-solid
+        /// voxels along x the ray steps without querying the accessor.
+        ///
+        /// Accessor contract:
+        /// - bool query(const ui32v3& voxel, OUT ui32& runStart, OUT ui32& runEnd)
+        ///   returning whether the voxel is solid, with [runStart, runEnd) the x range of the
+        ///   voxel's row that shares its solidity (at least the voxel itself)
+        /// @param accessor: Voxel queries
+        /// @param size: Sizes of the chunk (XYZ)
+        /// @param ray: Ray to cast
+        /// @return First solid voxel along the ray
+        template<typename Accessor>
+        VoxelRaycastResult raycast(const Accessor& accessor, const ui32v3& size, const VoxelRay& ray) {
+            const f32 INF = std::numeric_limits<f32>::infinity();
+            VoxelRaycastResult result;
+
+            // Clip the ray to the chunk bounds
+            f32 tEntry = 0.0f, tExit = ray.maxDistance;
+            i32 entryAxis = -1;
+            for (i32 i = 0; i < 3; i++) {
+                f32 o = ray.origin[i], d = ray.direction[i];
+                if (d == 0.0f) {
+                    if (o < 0.0f || o >= (f32)size[i]) return result;
+                    continue;
+                }
+                f32 t0 = (0.0f - o) / d;
+                f32 t1 = ((f32)size[i] - o) / d;
+                if (t0 > t1) std::swap(t0, t1);
+                if (t0 > tEntry) {
+                    tEntry = t0;
+                    entryAxis = i;
+                }
+                tExit = std::min(tExit, t1);
+            }
+            if (tEntry > tExit) return result;
+
+            i32v3 voxel, step;
+            f32v3 tMax, tDelta;
+            for (i32 i = 0; i < 3; i++) {
+                f32 d = ray.direction[i];
+                f32 p = ray.origin[i] + d * tEntry;
+                voxel[i] = std::min(std::max((i32)std::floor(p), 0), (i32)size[i] - 1);
+                if (i == entryAxis) voxel[i] = d > 0.0f ? 0 : (i32)size[i] - 1;
+
+                step[i] = d > 0.0f ? 1 : (d < 0.0f ? -1 : 0);
+                tDelta[i] = step[i] ? 1.0f / std::abs(d) : INF;
+                tMax[i] = step[i] ? ((f32)(voxel[i] + (step[i] > 0 ? 1 : 0)) - ray.origin[i]) / d : INF;
+            }
+
+            f32 t = tEntry;
+            i32 lastAxis = entryAxis;
+            while (true) {
+                ui32 runStart, runEnd;
+                if (accessor.query(ui32v3(voxel), runStart, runEnd)) {
+                    result.hit = true;
+                    result.voxel = ui32v3(voxel);
+                    result.distance = t;
+                    if (lastAxis >= 0) result.face = toCardinal((Axis)lastAxis, step[lastAxis] < 0);
+                    return result;
+                }
+
+                // Cross the rest of the empty run without queries
+                f32 tNextYZ = std::min(tMax.y, tMax.z);
+                while (tMax.x < tNextYZ) {
+                    i32 x = voxel.x + step.x;
+                    if (x < (i32)runStart || x >= (i32)runEnd) break;
+                    t = tMax.x;
+                    if (t > tExit) return result;
+                    voxel.x = x;
+                    tMax.x += tDelta.x;
+                    lastAxis = 0;
+                }
+
+                // Step into the next voxel
+                i32 axis = tMax.x < tMax.y ? (tMax.x < tMax.z ? 0 : 2) : (tMax.y < tMax.z ? 1 : 2);
+                t = tMax[axis];
+                if (t > tExit) return result;
+                voxel[axis] += step[axis];
+                if (voxel[axis] < 0 || voxel[axis] >= (i32)size[axis]) return result;
+                tMax[axis] += tDelta[axis];
+                lastAxis = axis;
+            }
+        }
+
+        /// Cast many rays through a chunk
+        /// @param accessor: Voxel queries
+        /// @param size: Sizes of the chunk (XYZ)
+        /// @param rays: Array of rays
+        /// @param count: Number of rays
+        /// @param results: Array of count results
+        template<typename Accessor>
+        void raycastBatch(const Accessor& accessor, const ui32v3& size, const VoxelRay* rays, size_t count,
+                          OUT VoxelRaycastResult* results) {
+            for (size_t i = 0; i < count; i++) {
+                results[i] = raycast(accessor, size, rays[i]);
+            }
+        }
+    }
+}
+namespace vvox = vorb::voxel;
+
+#endif // !Vorb_VoxelRaycast_h__
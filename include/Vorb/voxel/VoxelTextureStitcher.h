@@ -22,6 +22,7 @@
 #include "../types.h"
 #endif // !VORB_USING_PCH
 
+#include <unordered_map>
 #include <vector>
 
 /// Stores Information About An Atlas Page For Construction Purposes
@@ -60,7 +61,7 @@ namespace vorb {
             * @return Number of allocated pages
             */
             size_t getNumPages() const {
-                return m_pages.size();
+                return m_freeSlots.size();
             }
 
             const ui32& getTilesPerRow() const { return m_tilesPerRow; }
@@ -71,8 +72,24 @@ namespace vorb {
             VORB_NON_COPYABLE(VoxelTextureStitcher);
             void addPage();
 
-            // TODO(Ben): Bitfield for smaller mem usage
-            std::vector<bool*> m_pages; ///< list of pages. A page is just an array of bools.
+            /// @return First free slot at or after index, slots past the last page are free
+            ui32 findFree(ui32 index) const;
+            /// @return First used slot in [index, limit), or limit if there is none
+            ui32 findUsed(ui32 index, ui32 limit) const;
+            /// @return Up to 64 slot bits starting at index
+            ui64 getSlots(ui32 index, ui32 count) const;
+            /// Mark slots as used, adding pages as needed
+            void markUsed(ui32 index, ui32 count);
+            /// Find the first column of a page row where a box fits
+            /// @return Column of the box, or m_tilesPerRow if it does not fit in the row
+            ui32 findBoxInRow(ui32 rowIndex, ui32 minX, ui32 width, ui32 height) const;
+
+            std::vector<ui64> m_slots; ///< Used bit of every slot, with pages stored back to back
+            std::vector<ui32> m_freeSlots; ///< Number of free slots on each page
+            /// Where the last search for a run length ended, earlier slots can never fit it again
+            std::unordered_map<ui32, ui32> m_contiguousStarts;
+            /// Where the last search for a box (width << 32 | height) ended
+            std::unordered_map<ui64, ui32> m_boxStarts;
             ui32 m_oldestFreeSlot; ///< The left-most free slot in the atlas array
             ui32 m_tilesPerRow;
             ui32 m_tilesPerPage;
@@ -3,8 +3,17 @@
 #include "Vorb/MeshGenerators.h"
 
 #include "Vorb/graphics/GpuMemory.h"
+#include "Vorb/ThreadPool.h"
 #include "glm/glm.hpp"
 
+#include <algorithm>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
 const static float GOLDEN_RATIO = 1.61803398875f;
 
 const static int NUM_ICOSOHEDRON_VERTICES = 12;
@@ -52,101 +61,233 @@ const static ui32 ICOSOHEDRON_INDICES[60] = {
     9, 8, 1
 };
 
-class Vec3KeyFuncs {
-public:
-    size_t operator()(const f32v3& k)const {
-        return std::hash<float>()(k.x) ^ std::hash<float>()(k.y) ^ std::hash<float>()(k.z);
+namespace {
+    const size_t PARALLEL_MIN_TRIANGLES = 16384; ///< Smallest level that subdivides in parallel
+    const ui32 NUM_PARTITIONS = 8; ///< Fixed so the result doesn't depend on the core count
+
+    typedef std::unordered_map<ui64, ui32> EdgeMap; ///< Midpoint index of each edge
+
+    std::mutex cacheLock;
+    std::vector<std::shared_ptr<const vmesh::IcosphereMesh> > cache; ///< Generated levels, by lod
+
+    struct WorkerData {
+    public:
+        volatile bool stop = false; ///< Required by the thread pool
+    };
+
+    /// Partitions of a parallelFor that have not finished
+    struct ParallelBatch {
+    public:
+        std::mutex lock;
+        std::condition_variable cond;
+        ui32 pending = 0;
+    };
+
+    /// Runs one partition of a parallelFor and deletes itself afterwards
+    class PartitionTask : public vcore::IThreadPoolTask<WorkerData> {
+    public:
+        PartitionTask(const std::function<void(ui32)>* func, ParallelBatch* batch, ui32 index) :
+            m_func(func),
+            m_batch(batch),
+            m_index(index) {
+            // Empty
+        }
+
+        virtual void execute(WorkerData* workerData VORB_UNUSED) override {
+            (*m_func)(m_index);
+            std::lock_guard<std::mutex> lock(m_batch->lock);
+            if (--m_batch->pending == 0) m_batch->cond.notify_all();
+        }
+        virtual void cleanup() override {
+            delete this;
+        }
+    private:
+        const std::function<void(ui32)>* m_func;
+        ParallelBatch* m_batch; ///< Owned by the caller, which waits for every partition
+        ui32 m_index;
+    };
+
+    /// @return Workers for subdivision, shared by every level and started on first use
+    /// @pre cacheLock is held
+    vcore::ThreadPool<WorkerData>& getPool() {
+        static vcore::ThreadPool<WorkerData> pool;
+        static bool isInitialized = false;
+        if (!isInitialized) {
+            // The calling thread runs a partition too
+            ui32 numWorkers = std::min(std::thread::hardware_concurrency(), NUM_PARTITIONS);
+            pool.init(numWorkers > 1 ? numWorkers - 1 : 0);
+            isInitialized = true;
+        }
+        return pool;
     }
 
-    bool operator()(const f32v3& a, const f32v3& b)const {
-        return a.x == b.x && a.y == b.y && a.z == b.z;
+    inline f32v3 findMidpoint(const f32v3& vertex1, const f32v3& vertex2) {
+        return glm::normalize(f32v3((vertex1.x + vertex2.x) / 2.0f, (vertex1.y + vertex2.y) / 2.0f, (vertex1.z + vertex2.z) / 2.0f));
     }
-};
 
-inline f32v3 findMidpoint(const f32v3& vertex1, const f32v3& vertex2) {
-    return glm::normalize(f32v3((vertex1.x + vertex2.x) / 2.0f, (vertex1.y + vertex2.y) / 2.0f, (vertex1.z + vertex2.z) / 2.0f));
-}
+    /// @return Key of the edge between two vertices, independent of their order
+    inline ui64 edgeKey(ui32 a, ui32 b) {
+        return a < b ? ((ui64)a << 32) | b : ((ui64)b << 32) | a;
+    }
 
-void vmesh::generateIcosphereMesh(int lod, std::vector<ui32>& indices, std::vector<f32v3>& positions) {
-    std::vector<ui32> newIndices;
-    newIndices.reserve(256);
-
-    std::unordered_map<f32v3, ui32, Vec3KeyFuncs, Vec3KeyFuncs> vertexLookup;
-    
-    indices.resize(NUM_ICOSOHEDRON_INDICES);
-    for (ui32 i = 0; i < NUM_ICOSOHEDRON_INDICES; i++) {
-        indices[i] = ICOSOHEDRON_INDICES[i];
+    /// @return Partition that numbers the midpoint of an edge
+    inline ui32 edgeOwner(ui64 key) {
+        return (ui32)((key * 0x9E3779B97F4A7C15ull) >> 32) % NUM_PARTITIONS;
+    }
+
+    /*
+    i0
+    mp01   mp02
+    i1     mp12   i2
+    */
+    inline void writeSubdivided(ui32* out, ui32 i0, ui32 i1, ui32 i2, ui32 mp01, ui32 mp12, ui32 mp02) {
+        //Defined in counter clockwise order
+        out[0] = i0;   out[1] = mp01;  out[2] = mp02;
+        out[3] = mp01; out[4] = i1;    out[5] = mp12;
+        out[6] = mp02; out[7] = mp12;  out[8] = i2;
+        out[9] = mp01; out[10] = mp12; out[11] = mp02;
+    }
+
+    /// Run f(i) for every i in [0, count) on the subdivision pool
+    /// @pre cacheLock is held
+    void parallelFor(ui32 count, const std::function<void(ui32)>& f) {
+        if (getPool().getNumWorkers() == 0) {
+            for (ui32 i = 0; i < count; i++) f(i);
+            return;
+        }
+        if (count == 0) return;
+        ParallelBatch batch;
+        batch.pending = count - 1;
+        for (ui32 i = 1; i < count; i++) {
+            getPool().addTask(new PartitionTask(&f, &batch, i));
+        }
+        f(0);
+
+        std::unique_lock<std::mutex> lock(batch.lock);
+        batch.cond.wait(lock, [&] { return batch.pending == 0; });
     }
-    positions.resize(NUM_ICOSOHEDRON_VERTICES);
-    for (ui32 i = 0; i < NUM_ICOSOHEDRON_VERTICES; i++) {
-        positions[i] = glm::normalize(ICOSOHEDRON_VERTICES[i]);
-        vertexLookup[glm::normalize(ICOSOHEDRON_VERTICES[i])] = i;
+
+    /// Split each triangle into four, numbering midpoints in order of first use
+    void subdivideSerial(const std::vector<ui32>& indices, std::vector<f32v3>& positions, OUT std::vector<ui32>& newIndices) {
+        // A closed mesh has 3/2 edges per triangle
+        EdgeMap midpoints;
+        midpoints.reserve(indices.size() / 2);
+        positions.reserve(positions.size() + indices.size() / 2);
+        auto getMidpoint = [&](ui32 a, ui32 b) {
+            auto it = midpoints.emplace(edgeKey(a, b), (ui32)positions.size());
+            if (it.second) {
+                f32v3 midpoint = findMidpoint(positions[a], positions[b]);
+                positions.push_back(midpoint);
+            }
+            return it.first->second;
+        };
+
+        newIndices.resize(indices.size() * 4);
+        for (size_t j = 0; j < indices.size(); j += 3) {
+            ui32 mp01 = getMidpoint(indices[j], indices[j + 1]);
+            ui32 mp12 = getMidpoint(indices[j + 1], indices[j + 2]);
+            ui32 mp02 = getMidpoint(indices[j], indices[j + 2]);
+            writeSubdivided(&newIndices[j * 4], indices[j], indices[j + 1], indices[j + 2], mp01, mp12, mp02);
+        }
     }
 
-    for (ui32 i = 0; i < (ui32)lod; i++) {
-        for (ui32 j = 0; j < indices.size(); j += 3) {
-            /*
-            j
-            mp12   mp13
-            j+1    mp23   j+2
-            */
-            //Defined in counter clockwise order
-            f32v3 vertex1 = positions[indices[j + 0]];
-            f32v3 vertex2 = positions[indices[j + 1]];
-            f32v3 vertex3 = positions[indices[j + 2]];
-
-            f32v3 midPoint12 = findMidpoint(vertex1, vertex2);
-            f32v3 midPoint23 = findMidpoint(vertex2, vertex3);
-            f32v3 midPoint13 = findMidpoint(vertex1, vertex3);
-
-            ui32 mp12Index;
-            ui32 mp23Index;
-            ui32 mp13Index;
-
-            auto iter = vertexLookup.find(midPoint12);
-            if (iter != vertexLookup.end()) { //It is in the map
-                mp12Index = iter->second;
-            } else { //Not in the map
-                mp12Index = (ui32)positions.size();
-                positions.push_back(midPoint12);
-                vertexLookup[midPoint12] = mp12Index;
+    /// Split each triangle into four across threads
+    ///
+    /// Every edge belongs to one partition chosen by its key, which numbers the edge's
+    /// midpoint. The numbering only depends on the triangle order, never on thread timing.
+    void subdivideParallel(const std::vector<ui32>& indices, std::vector<f32v3>& positions, OUT std::vector<ui32>& newIndices) {
+        size_t numTriangles = indices.size() / 3;
+        auto triangleBegin = [&](ui32 p) { return numTriangles * p / NUM_PARTITIONS; };
+
+        // Route the edges of each range of triangles to their owners
+        std::vector<std::vector<ui64> > routed(NUM_PARTITIONS * NUM_PARTITIONS);
+        parallelFor(NUM_PARTITIONS, [&](ui32 p) {
+            for (size_t t = triangleBegin(p); t < triangleBegin(p + 1); t++) {
+                const ui32* tri = &indices[t * 3];
+                ui64 keys[3] = { edgeKey(tri[0], tri[1]), edgeKey(tri[1], tri[2]), edgeKey(tri[0], tri[2]) };
+                for (ui64 key : keys) routed[p * NUM_PARTITIONS + edgeOwner(key)].push_back(key);
             }
+        });
 
-            iter = vertexLookup.find(midPoint23);
-            if (iter != vertexLookup.end()) { //It is in the map
-                mp23Index = iter->second;
-            } else { //Not in the map
-                mp23Index = (ui32)positions.size();
-                positions.push_back(midPoint23);
-                vertexLookup[midPoint23] = mp23Index;
+        // Each owner numbers its distinct edges in triangle order
+        std::vector<EdgeMap> midpoints(NUM_PARTITIONS);
+        std::vector<std::vector<ui64> > edges(NUM_PARTITIONS);
+        parallelFor(NUM_PARTITIONS, [&](ui32 o) {
+            midpoints[o].reserve(indices.size() / 2 / NUM_PARTITIONS);
+            for (ui32 p = 0; p < NUM_PARTITIONS; p++) {
+                for (ui64 key : routed[p * NUM_PARTITIONS + o]) {
+                    if (midpoints[o].emplace(key, (ui32)edges[o].size()).second) edges[o].push_back(key);
+                }
             }
+        });
 
-            iter = vertexLookup.find(midPoint13);
-            if (iter != vertexLookup.end()) { //It is in the map
-                mp13Index = iter->second;
-            } else { //Not in the map
-                mp13Index = (ui32)positions.size();
-                positions.push_back(midPoint13);
-                vertexLookup[midPoint13] = mp13Index;
+        // Append the midpoints of each owner in turn
+        std::vector<ui32> bases(NUM_PARTITIONS);
+        size_t numPositions = positions.size();
+        for (ui32 o = 0; o < NUM_PARTITIONS; o++) {
+            bases[o] = (ui32)numPositions;
+            numPositions += edges[o].size();
+        }
+        positions.resize(numPositions);
+        parallelFor(NUM_PARTITIONS, [&](ui32 o) {
+            for (size_t i = 0; i < edges[o].size(); i++) {
+                ui64 key = edges[o][i];
+                positions[bases[o] + i] = findMidpoint(positions[(ui32)(key >> 32)], positions[(ui32)key]);
             }
+        });
 
-            newIndices.push_back(indices[j]);
-            newIndices.push_back(mp12Index);
-            newIndices.push_back(mp13Index);
+        newIndices.resize(indices.size() * 4);
+        parallelFor(NUM_PARTITIONS, [&](ui32 p) {
+            auto getMidpoint = [&](ui32 a, ui32 b) {
+                ui64 key = edgeKey(a, b);
+                ui32 o = edgeOwner(key);
+                return bases[o] + midpoints[o].find(key)->second;
+            };
+            for (size_t t = triangleBegin(p); t < triangleBegin(p + 1); t++) {
+                const ui32* tri = &indices[t * 3];
+                writeSubdivided(&newIndices[t * 12], tri[0], tri[1], tri[2],
+                                getMidpoint(tri[0], tri[1]), getMidpoint(tri[1], tri[2]), getMidpoint(tri[0], tri[2]));
+            }
+        });
+    }
+}
 
-            newIndices.push_back(mp12Index);
-            newIndices.push_back(indices[j + 1]);
-            newIndices.push_back(mp23Index);
+std::shared_ptr<const vmesh::IcosphereMesh> vmesh::getIcosphereMesh(int lod) {
+    std::lock_guard<std::mutex> lock(cacheLock);
 
-            newIndices.push_back(mp13Index);
-            newIndices.push_back(mp23Index);
-            newIndices.push_back(indices[j + 2]);
+    if (cache.empty()) {
+        std::shared_ptr<IcosphereMesh> base(new IcosphereMesh);
+        base->indices.assign(ICOSOHEDRON_INDICES, ICOSOHEDRON_INDICES + NUM_ICOSOHEDRON_INDICES);
+        base->positions.resize(NUM_ICOSOHEDRON_VERTICES);
+        for (ui32 i = 0; i < NUM_ICOSOHEDRON_VERTICES; i++) {
+            base->positions[i] = glm::normalize(ICOSOHEDRON_VERTICES[i]);
+        }
+        cache.push_back(std::move(base));
+    }
 
-            newIndices.push_back(mp12Index);
-            newIndices.push_back(mp23Index);
-            newIndices.push_back(mp13Index);
+    // Levels nest, so each one starts from the previous level's positions
+    lod = std::max(lod, 0);
+    while (cache.size() <= (size_t)lod) {
+        const IcosphereMesh& prev = *cache.back();
+        std::shared_ptr<IcosphereMesh> next(new IcosphereMesh);
+        next->positions = prev.positions;
+        if (prev.indices.size() / 3 >= PARALLEL_MIN_TRIANGLES) {
+            subdivideParallel(prev.indices, next->positions, next->indices);
+        } else {
+            subdivideSerial(prev.indices, next->positions, next->indices);
         }
-        indices.swap(newIndices);
-        newIndices.clear();
+        cache.push_back(std::move(next));
     }
-}
\ No newline at end of file
+    return cache[lod];
+}
+
+void vmesh::clearIcosphereCache() {
+    std::lock_guard<std::mutex> lock(cacheLock);
+    std::vector<std::shared_ptr<const IcosphereMesh> >().swap(cache);
+}
+
+void vmesh::generateIcosphereMesh(int lod, std::vector<ui32>& indices, std::vector<f32v3>& positions) {
+    std::shared_ptr<const IcosphereMesh> mesh = getIcosphereMesh(lod);
+    indices = mesh->indices;
+    positions = mesh->positions;
+}
@@ -5,6 +5,35 @@
 
 #include <png.h>
 #include "Vorb/graphics/ImageIOConv.inl"
+#include "Vorb/io/DerivedDataCache.h"
+
+namespace {
+    /// Bump whenever decoded pixels change, which invalidates cached images
+    const ui32 CACHE_VERSION = 1;
+
+    size_t getPixelSize(const vg::ImageIOFormat& format) {
+        switch (format) {
+        case vg::ImageIOFormat::RGB_UI8:
+            return sizeof(ui8)* 3;
+        case vg::ImageIOFormat::RGBA_UI8:
+            return sizeof(ui8)* 4;
+        case vg::ImageIOFormat::RGB_UI16:
+            return sizeof(ui16)* 3;
+        case vg::ImageIOFormat::RGBA_UI16:
+            return sizeof(ui16)* 4;
+        case vg::ImageIOFormat::RGB_F32:
+            return sizeof(f32)* 3;
+        case vg::ImageIOFormat::RGBA_F32:
+            return sizeof(f32)* 4;
+        case vg::ImageIOFormat::RGB_F64:
+            return sizeof(f64)* 3;
+        case vg::ImageIOFormat::RGBA_F64:
+            return sizeof(f64)* 4;
+        default:
+            return 0;
+        }
+    }
+}
 
 namespace vorb {
     namespace graphics {
@@ -30,35 +59,8 @@ vg::BitmapResource vg::ImageIO::alloc(const ui32& w, const ui32& h, const ImageI
     res.data = nullptr;
     res.width = w;
     res.height = h;
-    size_t size = 0;
-    switch (format) {
-    case ImageIOFormat::RGB_UI8:
-        size = sizeof(ui8)* 3;
-        break;
-    case ImageIOFormat::RGBA_UI8:
-        size = sizeof(ui8)* 4;
-        break;
-    case ImageIOFormat::RGB_UI16:
-        size = sizeof(ui16)* 3;
-        break;
-    case ImageIOFormat::RGBA_UI16:
-        size = sizeof(ui16)* 4;
-        break;
-    case ImageIOFormat::RGB_F32:
-        size = sizeof(f32)* 3;
-        break;
-    case ImageIOFormat::RGBA_F32:
-        size = sizeof(f32)* 4;
-        break;
-    case ImageIOFormat::RGB_F64:
-        size = sizeof(f64)* 3;
-        break;
-    case ImageIOFormat::RGBA_F64:
-        size = sizeof(f64)* 4;
-        break;
-    default:
-        return res;
-    }
+    size_t size = getPixelSize(format);
+    if (size == 0) return res;
     res.bytesUI8 = new ui8[size * res.width * res.height]();
     return res;
 }
@@ -132,7 +134,42 @@ std::pair<png_byte,png_byte> ImageIoFormatToPng(const vg::ImageIOFormat &format)
 // TODO: Get this in working order. Reevaluate parameter attribute once done.
 vg::BitmapResource vg::ImageIO::load(const vio::Path& path,
                                      const ImageIOFormat& requestedformat /* = ImageIOFormat::RGBA_UI8 */,
-                                     bool flipV /*= false*/ VORB_UNUSED) {
+                                     bool flipV /*= false*/) {
+    // The decoded pixels depend on the requested format and orientation as well as the file
+    vio::DerivedDataKey key;
+    ui32 settings[2] = { (ui32)requestedformat, flipV ? 1u : 0u };
+    if (!m_cache || !vio::DerivedDataCache::makeKey(path, "vg::ImageIO", CACHE_VERSION, vio::hash64(settings, sizeof(settings)), key)) {
+        return decode(path, requestedformat, flipV);
+    }
+
+    // Cached images are the width and height followed by the pixels
+    std::vector<ui8> cached;
+    if (m_cache->load(key, cached) && cached.size() >= sizeof(ui32) * 2) {
+        ui32 size[2];
+        memcpy(size, cached.data(), sizeof(size));
+        size_t bytes = (size_t)size[0] * size[1] * getPixelSize(requestedformat);
+        if (bytes == cached.size() - sizeof(size)) {
+            BitmapResource res = alloc(size[0], size[1], requestedformat);
+            if (res.data) memcpy(res.data, cached.data() + sizeof(size), bytes);
+            return res;
+        }
+    }
+
+    BitmapResource res = decode(path, requestedformat, flipV);
+    if (res.data) {
+        ui32 size[2] = { res.width, res.height };
+        size_t bytes = (size_t)res.width * res.height * getPixelSize(requestedformat);
+        cached.resize(sizeof(size) + bytes);
+        memcpy(cached.data(), size, sizeof(size));
+        memcpy(cached.data() + sizeof(size), res.data, bytes);
+        m_cache->store(key, cached.data(), cached.size());
+    }
+    return res;
+}
+
+vg::BitmapResource vg::ImageIO::decode(const vio::Path& path,
+                                       const ImageIOFormat& requestedformat,
+                                       bool flipV VORB_UNUSED) {
     BitmapResource res = {};
     res.data = nullptr;
 
@@ -0,0 +1,105 @@
+#include "Vorb/stdafx.h"
+#include "Vorb/io/AsyncFileReader.h"
+
+#include <algorithm>
+#include <atomic>
+
+/// A batch of paths and where their contents go
+struct vio::AsyncFileReader::Batch {
+public:
+    Batch(const IOManager& ioManager, const std::vector<Path>& paths) :
+        ioManager(ioManager),
+        results(paths.size()),
+        remaining(paths.size()) {
+        for (size_t i = 0; i < paths.size(); i++) results[i].path = paths[i];
+    }
+
+    IOManager ioManager; ///< Copy of the manager, which only holds its search directory
+    AsyncReadCallback callback; ///< Receives each result, unless the batch has a promise
+    std::vector<AsyncReadResult> results;
+    std::atomic<size_t> remaining; ///< Files not read yet
+    std::promise<std::vector<AsyncReadResult> > promise; ///< Fulfilled once remaining reaches zero
+};
+
+void vio::AsyncFileReader::ReadTask::execute(WorkerData* workerData VORB_UNUSED) {
+    AsyncReadResult& result = m_batch->results[m_index];
+    result.success = m_batch->ioManager.readFileToData(result.path, result.data);
+
+    if (m_batch->callback) {
+        m_batch->callback(result);
+        // The callback may have moved the data, free it either way
+        std::vector<ui8>().swap(result.data);
+        m_batch->remaining--;
+    } else if (--m_batch->remaining == 0) {
+        m_batch->promise.set_value(std::move(m_batch->results));
+    }
+
+    std::lock_guard<std::mutex> lock(m_reader->m_lock);
+    if (--m_reader->m_pending == 0) m_reader->m_cond.notify_all();
+}
+
+void vio::AsyncFileReader::init(ui32 workers) {
+    if (m_isInitialized) return;
+    m_isInitialized = true;
+    m_pool.init(std::max(workers, 1u));
+}
+
+void vio::AsyncFileReader::dispose() {
+    if (!m_isInitialized) return;
+    // Destroying the pool drops queued tasks, so let them finish first
+    wait();
+    m_pool.destroy();
+    m_isInitialized = false;
+}
+
+void vio::AsyncFileReader::read(const IOManager& ioManager, const std::vector<Path>& paths, AsyncReadCallback callback) {
+    std::shared_ptr<Batch> batch = std::make_shared<Batch>(ioManager, paths);
+    batch->callback = std::move(callback);
+    enqueue(batch);
+}
+
+std::future<std::vector<vio::AsyncReadResult> > vio::AsyncFileReader::read(const IOManager& ioManager, const std::vector<Path>& paths) {
+    std::shared_ptr<Batch> batch = std::make_shared<Batch>(ioManager, paths);
+    std::future<std::vector<AsyncReadResult> > future = batch->promise.get_future();
+    if (paths.empty()) {
+        batch->promise.set_value(std::vector<AsyncReadResult>());
+    } else {
+        enqueue(batch);
+    }
+    return future;
+}
+
+void vio::AsyncFileReader::wait() {
+    std::unique_lock<std::mutex> lock(m_lock);
+    m_cond.wait(lock, [this] { return m_pending == 0; });
+}
+
+vio::AsyncFileReader& vio::AsyncFileReader::getShared() {
+    static AsyncFileReader reader;
+    static std::once_flag started;
+    std::call_once(started, [] {
+        // Enough concurrent reads to keep an SSD busy without flooding a hard drive
+        reader.init(std::min(std::max(std::thread::hardware_concurrency(), 4u), 8u));
+    });
+    return reader;
+}
+
+size_t vio::AsyncFileReader::getPending() const {
+    std::lock_guard<std::mutex> lock(m_lock);
+    return m_pending;
+}
+
+void vio::AsyncFileReader::enqueue(const std::shared_ptr<Batch>& batch) {
+    size_t count = batch->results.size();
+    if (count == 0) return;
+
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        m_pending += count;
+    }
+    std::vector<vcore::IThreadPoolTask<WorkerData>*> tasks(count);
+    for (size_t i = 0; i < count; i++) {
+        tasks[i] = new ReadTask(this, batch, i);
+    }
+    m_pool.addTasks(tasks.data(), count);
+}
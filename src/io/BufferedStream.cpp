@@ -0,0 +1,180 @@
+#include "Vorb/stdafx.h"
+#include "Vorb/io/BufferedStream.h"
+
+#include <algorithm>
+#include <cstring>
+
+/************************************************************************/
+/* StreamReader                                                         */
+/************************************************************************/
+
+void vio::StreamReader::init(const FileStream& stream, void* buffer, size_t capacity) {
+    m_stream = stream;
+    m_buffer = (ui8*)buffer;
+    m_data = m_buffer;
+    m_capacity = capacity;
+    m_begin = 0;
+    m_end = 0;
+    m_consumed = 0;
+    m_streamOffset = 0;
+    m_streamEnded = !m_stream.isOpened();
+}
+
+void vio::StreamReader::init(const void* data, size_t size) {
+    m_stream = FileStream();
+    m_buffer = nullptr;
+    m_data = (const ui8*)data;
+    m_capacity = size;
+    m_begin = 0;
+    m_end = size;
+    m_consumed = 0;
+    m_streamOffset = 0;
+    m_streamEnded = true;
+}
+
+const ui8* vio::StreamReader::peek(size_t size) {
+    if (m_end - m_begin < size && !fill(size)) return nullptr;
+    return m_data + m_begin;
+}
+
+const ui8* vio::StreamReader::peekAvailable(OUT size_t& size) {
+    if (m_begin == m_end) fill(1);
+    size = m_end - m_begin;
+    return m_data + m_begin;
+}
+
+const ui8* vio::StreamReader::peekUntil(ui8 delimiter, OUT size_t& size) {
+    size_t searched = 0;
+    for (;;) {
+        const ui8* start = m_data + m_begin;
+        const void* found = memchr(start + searched, delimiter, m_end - m_begin - searched);
+        if (found) {
+            size = (const ui8*)found - start + 1;
+            return start;
+        }
+        searched = m_end - m_begin;
+        if (!fill(searched + 1)) break;
+    }
+
+    // Without a delimiter, the span is the rest of the stream if it all fit
+    size = m_end - m_begin;
+    if (size == 0 || !m_streamEnded) return nullptr;
+    return m_data + m_begin;
+}
+
+size_t vio::StreamReader::read(OUT void* data, size_t size) {
+    ui8* dst = (ui8*)data;
+    size_t copied = std::min(size, m_end - m_begin);
+    if (copied) memcpy(dst, m_data + m_begin, copied);
+    consume(copied);
+
+    size_t remaining = size - copied;
+    if (remaining >= m_capacity && !m_streamEnded) {
+        // Too large to be worth buffering, read straight into the destination
+        size_t direct = m_stream.read(remaining, 1, dst + copied);
+        m_streamOffset += direct;
+        m_consumed += direct;
+        if (direct < remaining) m_streamEnded = true;
+        return copied + direct;
+    }
+    while (remaining) {
+        if (!fill(1)) break;
+        size_t chunk = std::min(remaining, m_end - m_begin);
+        memcpy(dst + size - remaining, m_data + m_begin, chunk);
+        consume(chunk);
+        remaining -= chunk;
+    }
+    return size - remaining;
+}
+
+size_t vio::StreamReader::skip(size_t size) {
+    size_t skipped = 0;
+    while (skipped < size) {
+        if (m_begin == m_end && !fill(1)) break;
+        size_t chunk = std::min(size - skipped, m_end - m_begin);
+        consume(chunk);
+        skipped += chunk;
+    }
+    return skipped;
+}
+
+bool vio::StreamReader::fill(size_t size) {
+    if (m_end - m_begin >= size) return true;
+    if (m_streamEnded || size > m_capacity) return false;
+
+    // Slide the unconsumed bytes down so the refill can be as large as possible
+    if (m_begin) {
+        memmove(m_buffer, m_buffer + m_begin, m_end - m_begin);
+        m_end -= m_begin;
+        m_begin = 0;
+    }
+
+    while (m_end - m_begin < size) {
+        // End the read on a block boundary of the file when there is room to
+        size_t space = m_capacity - m_end;
+        size_t misalignment = (size_t)((m_streamOffset + space) % BLOCK_SIZE);
+        if (misalignment < space && space - misalignment >= size - (m_end - m_begin)) space -= misalignment;
+
+        size_t bytes = m_stream.read(space, 1, m_buffer + m_end);
+        m_end += bytes;
+        m_streamOffset += bytes;
+        if (bytes < space) {
+            m_streamEnded = true;
+            return m_end - m_begin >= size;
+        }
+    }
+    return true;
+}
+
+/************************************************************************/
+/* StreamWriter                                                         */
+/************************************************************************/
+
+void vio::StreamWriter::init(const FileStream& stream, void* buffer, size_t capacity) {
+    flush();
+    m_stream = stream;
+    m_buffer = (ui8*)buffer;
+    m_capacity = capacity;
+    m_end = 0;
+    m_committed = 0;
+    m_failed = !m_stream.isOpened();
+}
+
+ui8* vio::StreamWriter::reserve(size_t size) {
+    if (size > m_capacity || m_failed) return nullptr;
+    if (m_capacity - m_end < size && !flush()) return nullptr;
+    return m_buffer + m_end;
+}
+
+bool vio::StreamWriter::write(const void* data, size_t size) {
+    if (m_failed) return false;
+    if (m_capacity - m_end >= size) {
+        memcpy(m_buffer + m_end, data, size);
+        commit(size);
+        return true;
+    }
+
+    if (!flush()) return false;
+    if (size < m_capacity) {
+        memcpy(m_buffer, data, size);
+        commit(size);
+        return true;
+    }
+    // Too large to be worth buffering, write straight from the source
+    if (m_stream.write(size, 1, data) != size) {
+        m_failed = true;
+        return false;
+    }
+    m_committed += size;
+    return true;
+}
+
+bool vio::StreamWriter::flush() {
+    if (m_end == 0) return !m_failed;
+    if (m_failed || m_stream.write(m_end, 1, m_buffer) != m_end) {
+        m_failed = true;
+        return false;
+    }
+    m_end = 0;
+    return true;
+}
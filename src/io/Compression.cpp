@@ -0,0 +1,159 @@
+#include "Vorb/stdafx.h"
+#include "Vorb/io/Compression.h"
+
+#include <cstring>
+
+namespace {
+    const size_t MIN_MATCH = 4; ///< Shortest match worth encoding
+    const size_t LAST_LITERALS = 5; ///< Trailing bytes always stored as literals
+    const size_t MF_LIMIT = 12; ///< No match may start within this many bytes of the end
+    const size_t MAX_OFFSET = 65535; ///< Farthest a match may reach back
+    const ui32 HASH_BITS = 12;
+
+    inline ui32 read32(const ui8* p) {
+        ui32 v;
+        memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+    inline ui32 hash4(ui32 v) {
+        return (v * 2654435761u) >> (32 - HASH_BITS);
+    }
+
+    /// Write the extension bytes of a length that did not fit in its token nibble
+    inline ui8* writeLength(ui8* op, size_t length) {
+        while (length >= 255) {
+            *op++ = 255;
+            length -= 255;
+        }
+        *op++ = (ui8)length;
+        return op;
+    }
+
+    /// Read the extension bytes of a length, false if the input ran out
+    inline bool readLength(const ui8*& ip, const ui8* end, OUT size_t& length) {
+        ui8 b;
+        do {
+            if (ip == end) return false;
+            b = *ip++;
+            length += b;
+        } while (b == 255);
+        return true;
+    }
+}
+
+size_t vio::compressBound(size_t size) {
+    return size + size / 255 + 16;
+}
+
+size_t vio::compressBlock(const ui8* src, size_t size, OUT ui8* dst, size_t capacity) {
+    const ui8* ip = src;
+    const ui8* anchor = src;
+    const ui8* end = src + size;
+    ui8* op = dst;
+    ui8* opEnd = dst + capacity;
+
+    if (size >= MF_LIMIT) {
+        // Positions of recent 4-byte sequences, relative to src
+        ui32 table[1 << HASH_BITS];
+        memset(table, 0xFF, sizeof(table));
+        const ui8* matchLimit = end - LAST_LITERALS;
+        const ui8* searchLimit = end - MF_LIMIT;
+
+        while (ip <= searchLimit) {
+            ui32 seq = read32(ip);
+            ui32 h = hash4(seq);
+            ui32 candidate = table[h];
+            table[h] = (ui32)(ip - src);
+            if (candidate == 0xFFFFFFFFu || (size_t)(ip - src) - candidate > MAX_OFFSET || read32(src + candidate) != seq) {
+                ip++;
+                continue;
+            }
+
+            // Extend the match forwards, and backwards over pending literals
+            const ui8* match = src + candidate;
+            const ui8* matchEnd = ip + MIN_MATCH;
+            const ui8* ref = match + MIN_MATCH;
+            while (matchEnd < matchLimit && *matchEnd == *ref) {
+                matchEnd++;
+                ref++;
+            }
+            while (ip > anchor && match > src && ip[-1] == match[-1]) {
+                ip--;
+                match--;
+            }
+
+            size_t literals = ip - anchor;
+            size_t matchLength = matchEnd - ip - MIN_MATCH;
+            if ((size_t)(opEnd - op) < 1 + literals + literals / 255 + 2 + matchLength / 255 + 2) return 0;
+
+            ui8* token = op++;
+            *token = (ui8)((literals < 15 ? literals : 15) << 4);
+            if (literals >= 15) op = writeLength(op, literals - 15);
+            memcpy(op, anchor, literals);
+            op += literals;
+
+            ui16 offset = (ui16)(ip - match);
+            *op++ = (ui8)(offset & 0xFF);
+            *op++ = (ui8)(offset >> 8);
+
+            *token |= (ui8)(matchLength < 15 ? matchLength : 15);
+            if (matchLength >= 15) op = writeLength(op, matchLength - 15);
+
+            ip = matchEnd;
+            anchor = ip;
+        }
+    }
+
+    // The block always ends with a literal-only sequence
+    size_t literals = end - anchor;
+    if ((size_t)(opEnd - op) < 1 + literals + literals / 255 + 1) return 0;
+    ui8* token = op++;
+    *token = (ui8)((literals < 15 ? literals : 15) << 4);
+    if (literals >= 15) op = writeLength(op, literals - 15);
+    // Empty blocks may come with null buffers
+    if (literals) memcpy(op, anchor, literals);
+    op += literals;
+    return op - dst;
+}
+
+size_t vio::decompressBlock(const ui8* src, size_t size, OUT ui8* dst, size_t capacity) {
+    const ui8* ip = src;
+    const ui8* end = src + size;
+    ui8* op = dst;
+    ui8* opEnd = dst + capacity;
+
+    while (ip < end) {
+        ui8 token = *ip++;
+
+        size_t literals = token >> 4;
+        if (literals == 15 && !readLength(ip, end, literals)) return 0;
+        if ((size_t)(end - ip) < literals || (size_t)(opEnd - op) < literals) return 0;
+        if (literals) memcpy(op, ip, literals);
+        ip += literals;
+        op += literals;
+
+        // The last sequence has no match
+        if (ip == end) break;
+
+        if (end - ip < 2) return 0;
+        size_t offset = ip[0] | ((size_t)ip[1] << 8);
+        ip += 2;
+        if (offset == 0 || offset > (size_t)(op - dst)) return 0;
+
+        size_t matchLength = token & 0x0F;
+        if (matchLength == 15 && !readLength(ip, end, matchLength)) return 0;
+        matchLength += MIN_MATCH;
+        if ((size_t)(opEnd - op) < matchLength) return 0;
+
+        // Matches may overlap their output, so copy byte by byte when they are close
+        const ui8* match = op - offset;
+        if (offset >= matchLength) {
+            memcpy(op, match, matchLength);
+            op += matchLength;
+        } else {
+            for (size_t i = 0; i < matchLength; i++) *op++ = *match++;
+        }
+    }
+    return op - dst;
+}
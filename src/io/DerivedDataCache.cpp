@@ -0,0 +1,143 @@
+#include "Vorb/stdafx.h"
+#include "Vorb/io/DerivedDataCache.h"
+
+#include "Vorb/io/Compression.h"
+#include "Vorb/io/File.h"
+#include "Vorb/io/FileOps.h"
+#include "Vorb/io/MappedFile.h"
+
+#include <atomic>
+#include <cinttypes>
+#include <cstring>
+#include <thread>
+
+namespace {
+    const ui32 MAGIC = 0x43444456; ///< "VDDC"
+    const ui32 VERSION = 1;
+    const ui32 COMPRESSED = 0x01;
+
+    /// Leads every entry file, followed by the stored bytes
+    struct EntryHeader {
+    public:
+        ui32 magic;
+        ui32 version;
+        ui64 sourceHash;
+        ui64 processorHash;
+        ui64 settingsHash;
+        ui32 processorVersion;
+        ui32 flags; ///< COMPRESSED if the stored bytes are compressed
+        ui64 size; ///< Bytes of the original data
+        ui64 storedSize; ///< Bytes following the header
+        ui64 dataHash; ///< Hash of the stored bytes, to catch damaged files
+    };
+
+    std::atomic<ui32> tempCounter(0);
+}
+
+ui64 vio::DerivedDataKey::combine() const {
+    ui64 parts[4] = { sourceHash, processorHash, settingsHash, (ui64)processorVersion };
+    ui8 bytes[sizeof(parts)];
+    // Serialize explicitly so keys name the same file on every platform
+    for (size_t i = 0; i < 4; i++) {
+        for (size_t b = 0; b < 8; b++) bytes[i * 8 + b] = (ui8)(parts[i] >> (b * 8));
+    }
+    return hash64(bytes, sizeof(bytes));
+}
+
+bool vio::DerivedDataCache::init(const Path& directory) {
+    m_directory = directory;
+    return buildDirectoryTree(directory) && directory.isDirectory();
+}
+
+bool vio::DerivedDataCache::makeKey(const Path& source, const nString& processor, ui32 processorVersion, ui64 settingsHash, OUT DerivedDataKey& key) {
+    File file;
+    ui64 sourceHash;
+    if (!source.asFile(&file) || !file.computeHash(sourceHash)) return false;
+    key = DerivedDataKey(sourceHash, processor, processorVersion, settingsHash);
+    return true;
+}
+
+bool vio::DerivedDataCache::load(const DerivedDataKey& key, OUT std::vector<ui8>& data) const {
+    MappedFile mapping;
+    if (!mapping.open(Path(getEntryPath(key)))) return false;
+
+    EntryHeader header;
+    if (mapping.getSize() < sizeof(header)) return false;
+    memcpy(&header, mapping.getData(), sizeof(header));
+    const ui8* stored = mapping.getData() + sizeof(header);
+    if (header.magic != MAGIC || header.version != VERSION ||
+        header.sourceHash != key.sourceHash || header.processorHash != key.processorHash ||
+        header.settingsHash != key.settingsHash || header.processorVersion != key.processorVersion ||
+        header.storedSize != mapping.getSize() - sizeof(header) ||
+        hash64(stored, (size_t)header.storedSize) != header.dataHash) {
+        return false;
+    }
+
+    if (header.flags & COMPRESSED) {
+        // A compressed block expands at most 255 times
+        if (header.size / 255 > header.storedSize) return false;
+        data.resize((size_t)header.size);
+        return decompressBlock(stored, (size_t)header.storedSize, data.data(), data.size()) == data.size();
+    }
+    if (header.storedSize != header.size) return false;
+    data.assign(stored, stored + header.storedSize);
+    return true;
+}
+
+bool vio::DerivedDataCache::store(const DerivedDataKey& key, const void* data, size_t size) const {
+    if (m_directory.isNull()) return false;
+
+    EntryHeader header = {};
+    header.magic = MAGIC;
+    header.version = VERSION;
+    header.sourceHash = key.sourceHash;
+    header.processorHash = key.processorHash;
+    header.settingsHash = key.settingsHash;
+    header.processorVersion = key.processorVersion;
+    header.size = size;
+    header.storedSize = size;
+
+    // Keep the data raw when compression doesn't pay off
+    const void* stored = data;
+    std::vector<ui8> compressed;
+    if (size) {
+        compressed.resize(compressBound(size));
+        size_t compressedSize = compressBlock((const ui8*)data, size, compressed.data(), compressed.size());
+        if (compressedSize && compressedSize < size) {
+            stored = compressed.data();
+            header.storedSize = compressedSize;
+            header.flags |= COMPRESSED;
+        }
+    }
+    header.dataHash = hash64(stored, (size_t)header.storedSize);
+
+    // Give every writer its own temporary file, so concurrent stores of a key can't interleave
+    nString path = getEntryPath(key);
+    nString tempPath = path + ".tmp" +
+        std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + "-" + std::to_string(tempCounter++);
+    FILE* file = fopen(tempPath.c_str(), "wb");
+    if (!file) return false;
+    bool success = fwrite(&header, sizeof(header), 1, file) == 1 &&
+        (header.storedSize == 0 || fwrite(stored, 1, (size_t)header.storedSize, file) == header.storedSize);
+    success = fclose(file) == 0 && success;
+
+#ifdef VORB_OS_WINDOWS
+    // Windows cannot rename over an existing file
+    if (success) ::remove(path.c_str());
+#endif
+    if (!success || rename(tempPath.c_str(), path.c_str()) != 0) {
+        ::remove(tempPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool vio::DerivedDataCache::remove(const DerivedDataKey& key) const {
+    return ::remove(getEntryPath(key).c_str()) == 0;
+}
+
+nString vio::DerivedDataCache::getEntryPath(const DerivedDataKey& key) const {
+    char name[32];
+    snprintf(name, sizeof(name), "%016" PRIx64 ".vdd", (uint64_t)key.combine());
+    return (m_directory / nString(name)).getString();
+}
@@ -3,11 +3,152 @@
 
 #include "Vorb/io/filesystem.h"
 
+#include <algorithm>
+#include <cctype>
+#include <condition_variable>
+#include <thread>
+
+namespace {
+    bool matchGlob(const char* p, const char* s) {
+        for (; *p; p++, s++) {
+            if (*p == '*') {
+                bool crossDirs = p[1] == '*';
+                while (*p == '*') p++;
+                // "**/" may also match no directories at all
+                if (crossDirs && *p == '/' && matchGlob(p + 1, s)) return true;
+                for (;; s++) {
+                    if (matchGlob(p, s)) return true;
+                    if (!*s || (!crossDirs && *s == '/')) return false;
+                }
+            }
+            if (!*s || (*p == '?' ? *s == '/' : *p != *s)) return false;
+        }
+        return !*s;
+    }
+
+    bool hasExtension(const nString& name, const nString& extension) {
+        size_t start = extension.size() && extension[0] == '.' ? 1 : 0;
+        size_t length = extension.size() - start;
+        if (name.size() <= length || name[name.size() - length - 1] != '.') return false;
+        for (size_t i = 0; i < length; i++) {
+            if (tolower((ui8)name[name.size() - length + i]) != tolower((ui8)extension[start + i])) return false;
+        }
+        return true;
+    }
+
+    /// Work shared by the threads of a scan
+    struct ScanState {
+    public:
+        std::mutex lock;
+        std::condition_variable cond; ///< Signals new directories or the end of the scan
+        std::vector<std::pair<fs::path, nString> > pending; ///< Directories to list, with their relative paths
+        size_t busy = 0; ///< Threads listing a directory
+        vio::DirectoryScanResults* results;
+    };
+
+    void scanWorker(ScanState& state, const vio::DirectoryScanOptions& options) {
+        vio::DirectoryScanResults found;
+        std::vector<std::pair<fs::path, nString> > subdirectories;
+        for (;;) {
+            std::pair<fs::path, nString> directory;
+            {
+                std::unique_lock<std::mutex> lock(state.lock);
+                state.cond.wait(lock, [&] { return !state.pending.empty() || state.busy == 0; });
+                if (state.pending.empty()) break;
+                directory = std::move(state.pending.back());
+                state.pending.pop_back();
+                state.busy++;
+            }
+
+            fs_error_code ec;
+            fs::directory_iterator entry(directory.first, ec);
+            fs::directory_iterator END;
+            for (; !ec && entry != END; entry.increment(ec)) {
+                const fs::path& e = entry->path();
+                nString leaf = e.filename().string();
+                nString relativePath = directory.second.empty() ? leaf : directory.second + "/" + leaf;
+                fs_error_code statusError;
+                if (fs::is_directory(entry->status(statusError))) {
+                    if (options.recursive && !fs::is_symlink(entry->symlink_status(statusError))) {
+                        subdirectories.emplace_back(e, relativePath);
+                    }
+                    if (!options.includeDirectories) continue;
+                    found.emplace_back();
+                    found.back().isDirectory = true;
+                } else if (fs::exists(entry->status(statusError)) && options.matches(relativePath)) {
+                    found.emplace_back();
+                } else {
+                    continue;
+                }
+                vio::DirectoryScanEntry& result = found.back();
+                result.path = vio::Path(e.string());
+                result.relativePath = std::move(relativePath);
+                result.modTime = result.path.getLastModTime();
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(state.lock);
+                for (auto& d : subdirectories) state.pending.push_back(std::move(d));
+                state.busy--;
+            }
+            subdirectories.clear();
+            state.cond.notify_all();
+        }
+
+        std::lock_guard<std::mutex> lock(state.lock);
+        for (auto& e : found) state.results->push_back(std::move(e));
+    }
+}
+
+bool vio::DirectoryScanOptions::matches(const nString& relativePath) const {
+    if (!extensions.empty()) {
+        bool found = false;
+        for (auto& extension : extensions) {
+            if (hasExtension(relativePath, extension)) {
+                found = true;
+                break;
+            }
+        }
+        if (!found) return false;
+    }
+    if (patterns.empty()) return true;
+
+    size_t slash = relativePath.find_last_of('/');
+    const char* leaf = relativePath.c_str() + (slash == nString::npos ? 0 : slash + 1);
+    for (auto& pattern : patterns) {
+        bool isPath = pattern.find('/') != nString::npos;
+        if (::matchGlob(pattern.c_str(), isPath ? relativePath.c_str() : leaf)) return true;
+    }
+    return false;
+}
+
 vio::Directory::Directory(const Path& p) :
     m_path(p) {
     // Empty
 }
 
+size_t vio::Directory::scan(OUT DirectoryScanResults& entries, const DirectoryScanOptions& options /*= DirectoryScanOptions()*/) const {
+    size_t c = entries.size();
+    ScanState state;
+    state.pending.emplace_back(fs::path(m_path.getString()), nString());
+    state.results = &entries;
+
+    // This thread walks too, the others only help
+    ui32 threads = options.threads;
+    if (threads == 0) threads = std::min(std::max(std::thread::hardware_concurrency(), 1u), 8u);
+    std::vector<std::thread> helpers;
+    for (ui32 i = 1; i < threads; i++) {
+        helpers.emplace_back(scanWorker, std::ref(state), std::cref(options));
+    }
+    scanWorker(state, options);
+    for (auto& t : helpers) t.join();
+
+    std::sort(entries.begin() + c, entries.end(), [] (const DirectoryScanEntry& a, const DirectoryScanEntry& b) {
+        return a.relativePath < b.relativePath;
+    });
+    return entries.size() - c;
+}
+
 bool vio::Directory::isEmpty() const {
     fs::path p(m_path.getString());
     return fs::is_empty(p);
@@ -38,3 +179,7 @@ void vio::Directory::forEachEntry(DirectoryEntryCallback* f) const {
         entry++;
     }
 }
+
+bool vio::Directory::matchGlob(const nString& pattern, const nString& s) {
+    return ::matchGlob(pattern.c_str(), s.c_str());
+}
@@ -0,0 +1,219 @@
+#include "Vorb/stdafx.h"
+#include "Vorb/io/DirectoryWatcher.h"
+
+#include "Vorb/io/IOManager.h"
+
+#ifdef VORB_OS_LINUX
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif // VORB_OS_LINUX
+
+#ifdef VORB_OS_LINUX
+namespace {
+    const ui32 WATCH_MASK = IN_CREATE | IN_CLOSE_WRITE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_ONLYDIR;
+}
+#endif // VORB_OS_LINUX
+
+bool vio::DirectoryWatcher::init(const Path& root, const DirectoryScanOptions& options /*= DirectoryScanOptions()*/, bool forcePolling /*= false*/) {
+    dispose();
+    if (!root.isDirectory()) return false;
+    m_root = root;
+    m_options = options;
+    m_isInitialized = true;
+
+#ifdef VORB_OS_LINUX
+    if (!forcePolling) m_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+#endif // VORB_OS_LINUX
+    if (m_fd < 0) {
+        rescan();
+        m_lastPoll = std::chrono::steady_clock::now();
+    } else {
+        watchTree("");
+    }
+    // Files that existed before init are not changes
+    m_changes.clear();
+    return true;
+}
+
+void vio::DirectoryWatcher::dispose() {
+    if (!m_isInitialized) return;
+#ifdef VORB_OS_LINUX
+    if (m_fd >= 0) close(m_fd);
+#endif // VORB_OS_LINUX
+    m_fd = -1;
+    std::map<nString, time_t>().swap(m_files);
+    m_changes.clear();
+    m_watches.clear();
+    m_isInitialized = false;
+}
+
+void vio::DirectoryWatcher::update() {
+    if (!m_isInitialized) return;
+    if (m_fd >= 0) {
+        readNotifications();
+    } else if (std::chrono::steady_clock::now() - m_lastPoll >= m_pollInterval) {
+        rescan();
+        m_lastPoll = std::chrono::steady_clock::now();
+    }
+
+    // Subscribers may call update again, so report from a local copy
+    std::map<nString, FileChangeType> changes;
+    changes.swap(m_changes);
+    for (auto& kvp : changes) {
+        FileChange change;
+        change.path = m_root / kvp.first;
+        change.relativePath = kvp.first;
+        change.type = kvp.second;
+        if (change.type != FileChangeType::MODIFIED) {
+            // Paths that resolved to the file, or failed to, may resolve differently now
+            Path absolutePath = change.path;
+            IOManager::invalidatePathCache(absolutePath.makeAbsolute());
+        }
+        onChange(change);
+    }
+}
+
+void vio::DirectoryWatcher::rescan() {
+    Directory dir;
+    DirectoryScanResults entries;
+    if (m_root.asDirectory(&dir)) dir.scan(entries, m_options);
+
+    // Both lists are sorted, so walk them side by side
+    std::map<nString, time_t> files;
+    auto known = m_files.begin();
+    for (auto& entry : entries) {
+        while (known != m_files.end() && known->first < entry.relativePath) {
+            queueChange(known->first, FileChangeType::REMOVED);
+            known++;
+        }
+        if (known != m_files.end() && known->first == entry.relativePath) {
+            if (known->second != entry.modTime) queueChange(entry.relativePath, FileChangeType::MODIFIED);
+            known++;
+        } else {
+            queueChange(entry.relativePath, FileChangeType::ADDED);
+        }
+        files.emplace_hint(files.end(), entry.relativePath, entry.modTime);
+    }
+    for (; known != m_files.end(); known++) {
+        queueChange(known->first, FileChangeType::REMOVED);
+    }
+    m_files.swap(files);
+}
+
+void vio::DirectoryWatcher::watchTree(const nString& relativePath) {
+#ifdef VORB_OS_LINUX
+    Path path = relativePath.empty() ? m_root : m_root / relativePath;
+    int wd = inotify_add_watch(m_fd, path.getCString(), WATCH_MASK);
+    if (wd < 0) return;
+    m_watches[wd] = relativePath;
+
+    // The directory may have been filled before the watch existed
+    Directory dir;
+    if (!path.asDirectory(&dir)) return;
+    // Filters apply to paths from the root, so test them here rather than in the scan
+    DirectoryScanOptions options;
+    options.includeDirectories = true;
+    options.recursive = false;
+    options.threads = 1;
+    DirectoryScanResults entries;
+    dir.scan(entries, options);
+    for (auto& entry : entries) {
+        nString entryPath = relativePath.empty() ? entry.relativePath : relativePath + "/" + entry.relativePath;
+        if (entry.isDirectory) {
+            if (m_options.recursive) watchTree(entryPath);
+        } else if (m_options.matches(entryPath)) {
+            queueChange(entryPath, m_files.count(entryPath) ? FileChangeType::MODIFIED : FileChangeType::ADDED);
+            m_files[entryPath] = entry.modTime;
+        }
+    }
+#endif // VORB_OS_LINUX
+}
+
+void vio::DirectoryWatcher::readNotifications() {
+#ifdef VORB_OS_LINUX
+    alignas(inotify_event) char buffer[4096];
+    bool overflowed = false;
+    for (;;) {
+        ssize_t length = read(m_fd, buffer, sizeof(buffer));
+        if (length <= 0) break;
+
+        for (char* p = buffer; p < buffer + length;) {
+            const inotify_event* event = (const inotify_event*)p;
+            p += sizeof(inotify_event) + event->len;
+
+            if (event->mask & IN_Q_OVERFLOW) {
+                overflowed = true;
+                continue;
+            }
+            auto watch = m_watches.find(event->wd);
+            if (watch == m_watches.end()) continue;
+            if (event->mask & IN_IGNORED) {
+                m_watches.erase(watch);
+                continue;
+            }
+            if (event->len == 0) continue;
+
+            nString relativePath = watch->second.empty() ? nString(event->name) : watch->second + "/" + event->name;
+            if (event->mask & IN_ISDIR) {
+                if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+                    if (m_options.recursive) watchTree(relativePath);
+                } else {
+                    removeTree(relativePath);
+                }
+            } else if (m_options.matches(relativePath)) {
+                if (event->mask & (IN_DELETE | IN_MOVED_FROM)) {
+                    if (m_files.erase(relativePath)) queueChange(relativePath, FileChangeType::REMOVED);
+                } else {
+                    time_t modTime = (m_root / relativePath).getLastModTime();
+                    queueChange(relativePath, m_files.count(relativePath) ? FileChangeType::MODIFIED : FileChangeType::ADDED);
+                    m_files[relativePath] = modTime;
+                }
+            }
+        }
+    }
+
+    // Events were lost, so compare against a fresh scan instead
+    if (overflowed) rescan();
+#endif // VORB_OS_LINUX
+}
+
+void vio::DirectoryWatcher::queueChange(const nString& relativePath, FileChangeType type) {
+    auto it = m_changes.find(relativePath);
+    if (it == m_changes.end()) {
+        m_changes[relativePath] = type;
+        return;
+    }
+
+    FileChangeType previous = it->second;
+    if (previous == FileChangeType::ADDED && type == FileChangeType::REMOVED) {
+        // Never seen by subscribers
+        m_changes.erase(it);
+    } else if (previous == FileChangeType::ADDED) {
+        // Still new to subscribers
+    } else if (previous == FileChangeType::REMOVED && type == FileChangeType::ADDED) {
+        it->second = FileChangeType::MODIFIED;
+    } else {
+        it->second = type;
+    }
+}
+
+void vio::DirectoryWatcher::removeTree(const nString& relativePath) {
+    nString prefix = relativePath + "/";
+#ifdef VORB_OS_LINUX
+    // A directory moved out of the tree keeps its watches, which would report stale paths
+    for (auto it = m_watches.begin(); it != m_watches.end();) {
+        if (it->second == relativePath || it->second.compare(0, prefix.size(), prefix) == 0) {
+            inotify_rm_watch(m_fd, it->first);
+            it = m_watches.erase(it);
+        } else {
+            it++;
+        }
+    }
+#endif // VORB_OS_LINUX
+
+    auto it = m_files.lower_bound(prefix);
+    while (it != m_files.end() && it->first.compare(0, prefix.size(), prefix) == 0) {
+        queueChange(it->first, FileChangeType::REMOVED);
+        it = m_files.erase(it);
+    }
+}
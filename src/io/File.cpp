@@ -8,6 +8,8 @@
 
 #include "Vorb/io/FileOps.h"
 #include "Vorb/io/FileStream.h"
+#include "Vorb/io/Hash.h"
+#include "Vorb/io/MappedFile.h"
 
 namespace vorb {
     namespace io {
@@ -44,6 +46,13 @@ bool vorb::io::File::resize(const ui64& l) const {
     return ec.value() == 0;
 }
 
+bool vorb::io::File::computeHash(OUT ui64& hash) const {
+    MappedFile mapping;
+    if (!mapping.open(m_path)) return false;
+    hash = hash64(mapping.getData(), mapping.getSize());
+    return true;
+}
+
 //void vorb::io::File::computeSum(vio::SHA256Sum* sum) const {
 //    vio::FileSeekOffset l = 0;
 //    ui8* data = nullptr;
@@ -96,3 +105,8 @@ vio::FileStream vio::File::openReadOnly(const bool& binary /*= true*/) const {
 vio::FileStream vio::File::create(const bool& binary /*= true*/) const {
     return open(FileOpenFlags::READ_WRITE_CREATE | (binary ? FileOpenFlags::BINARY : FileOpenFlags::NONE));
 }
+vio::MappedFile vio::File::map() const {
+    MappedFile mapping;
+    mapping.open(m_path);
+    return mapping;
+}
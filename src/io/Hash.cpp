@@ -0,0 +1,86 @@
+#include "Vorb/stdafx.h"
+#include "Vorb/io/Hash.h"
+
+#include <cstring>
+
+namespace {
+    const ui64 PRIME_1 = 11400714785074694791ull;
+    const ui64 PRIME_2 = 14029467366897019727ull;
+    const ui64 PRIME_3 = 1609587929392839161ull;
+    const ui64 PRIME_4 = 9650029242287828579ull;
+    const ui64 PRIME_5 = 2870177450012600261ull;
+
+    inline ui64 rotl(ui64 x, int r) {
+        return (x << r) | (x >> (64 - r));
+    }
+
+    // Loads are little-endian regardless of the host, which keeps stored hashes portable
+    inline ui64 read64(const ui8* p) {
+        return (ui64)p[0] | ((ui64)p[1] << 8) | ((ui64)p[2] << 16) | ((ui64)p[3] << 24) |
+            ((ui64)p[4] << 32) | ((ui64)p[5] << 40) | ((ui64)p[6] << 48) | ((ui64)p[7] << 56);
+    }
+    inline ui64 read32(const ui8* p) {
+        return (ui64)p[0] | ((ui64)p[1] << 8) | ((ui64)p[2] << 16) | ((ui64)p[3] << 24);
+    }
+
+    inline ui64 round(ui64 acc, ui64 input) {
+        acc += input * PRIME_2;
+        return rotl(acc, 31) * PRIME_1;
+    }
+    inline ui64 mergeRound(ui64 acc, ui64 value) {
+        acc ^= round(0, value);
+        return acc * PRIME_1 + PRIME_4;
+    }
+}
+
+ui64 vio::hash64(const void* data, size_t size, ui64 seed /*= 0*/) {
+    const ui8* p = (const ui8*)data;
+    const ui8* end = p + size;
+    ui64 h;
+
+    if (size >= 32) {
+        // Four independent lanes keep the multipliers busy
+        ui64 v1 = seed + PRIME_1 + PRIME_2;
+        ui64 v2 = seed + PRIME_2;
+        ui64 v3 = seed;
+        ui64 v4 = seed - PRIME_1;
+        const ui8* limit = end - 32;
+        do {
+            v1 = round(v1, read64(p));
+            v2 = round(v2, read64(p + 8));
+            v3 = round(v3, read64(p + 16));
+            v4 = round(v4, read64(p + 24));
+            p += 32;
+        } while (p <= limit);
+
+        h = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+        h = mergeRound(h, v1);
+        h = mergeRound(h, v2);
+        h = mergeRound(h, v3);
+        h = mergeRound(h, v4);
+    } else {
+        h = seed + PRIME_5;
+    }
+    h += (ui64)size;
+
+    for (; p + 8 <= end; p += 8) {
+        h ^= round(0, read64(p));
+        h = rotl(h, 27) * PRIME_1 + PRIME_4;
+    }
+    if (p + 4 <= end) {
+        h ^= read32(p) * PRIME_1;
+        h = rotl(h, 23) * PRIME_2 + PRIME_3;
+        p += 4;
+    }
+    for (; p < end; p++) {
+        h ^= (*p) * PRIME_5;
+        h = rotl(h, 11) * PRIME_1;
+    }
+
+    h ^= h >> 33;
+    h *= PRIME_2;
+    h ^= h >> 29;
+    h *= PRIME_3;
+    h ^= h >> 32;
+    return h;
+}
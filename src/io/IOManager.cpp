@@ -1,9 +1,87 @@
 #include "Vorb/stdafx.h"
 #include "Vorb/io/IOManager.h"
 
+#include "Vorb/io/AsyncFileReader.h"
 #include "Vorb/io/FileOps.h"
+#include "Vorb/io/MappedFile.h"
+#include "Vorb/io/PackFile.h"
 #include "Vorb/utils.h"
 
+namespace {
+    const size_t MAX_CACHED_PATHS = 65536; ///< The cache is emptied when it grows past this
+
+    /// Outcome of resolving a path
+    struct ResolvedPath {
+    public:
+        bool found;
+        bool isFile; ///< True if the path was found and is a file
+        vio::Path path; ///< Absolute path, if found
+    };
+
+    std::mutex pathCacheLock;
+    /// Resolutions keyed by search directory and path, separated by a null character
+    std::unordered_map<nString, ResolvedPath> pathCache;
+
+    nString makePathKey(const vio::Path& searchDirectory, const vio::Path& path) {
+        nString key;
+        key.reserve(searchDirectory.getString().size() + path.getString().size() + 1);
+        key += searchDirectory.getString();
+        key += '\0';
+        key += path.getString();
+        return key;
+    }
+
+    /// @return True if a path names the same file as the relative path stored in a key from start
+    bool endsWithPath(const nString& path, const nString& key, size_t start) {
+        size_t length = key.size() - start;
+        if (length == 0 || length > path.size()) return false;
+        size_t offset = path.size() - length;
+        if (path.compare(offset, length, key, start, length) != 0) return false;
+        return offset == 0 || path[offset - 1] == '/' || path[offset - 1] == '\\';
+    }
+
+    typedef std::vector<std::shared_ptr<vio::PackFile> > PackList;
+
+    std::mutex packLock;
+    /// Mounted packs, newest first, replaced whenever one is mounted or unmounted
+    std::shared_ptr<const PackList> mountedPacks;
+
+    /// Find a relative path in the mounted packs
+    /// @param path: Path as named in the packs
+    /// @param pack: Receives the pack holding the file, which keeps the entry alive
+    /// @return The file's entry, or null if no pack has it
+    const vio::PackEntry* findPacked(const PackList& packs, const vio::Path& path, OUT std::shared_ptr<vio::PackFile>& pack) {
+        for (auto& p : packs) {
+            const vio::PackEntry* entry = p->find(path.getString());
+            if (entry) {
+                pack = p;
+                return entry;
+            }
+        }
+        return nullptr;
+    }
+    /// Find a relative path in the mounted packs, trying it within a relative search directory first
+    /// @param searchDirectory: Search directory of the manager
+    /// @param path: Path to find
+    /// @param pack: Receives the pack holding the file, which keeps the entry alive
+    /// @return The file's entry, or null if no pack has it
+    const vio::PackEntry* findPacked(const vio::Path& searchDirectory, const vio::Path& path, OUT std::shared_ptr<vio::PackFile>& pack) {
+        std::shared_ptr<const PackList> packs;
+        {
+            std::lock_guard<std::mutex> lock(packLock);
+            packs = mountedPacks;
+        }
+        if (!packs || path.isAbsolute()) return nullptr;
+
+        // Mirror the search order of resolvePath, where packs stand in for the other directories
+        if (!searchDirectory.isNull() && !searchDirectory.isAbsolute()) {
+            const vio::PackEntry* entry = findPacked(*packs, searchDirectory / path, pack);
+            if (entry) return entry;
+        }
+        return findPacked(*packs, path, pack);
+    }
+}
+
 vio::IOManager::IOManager() :
     m_pathSearch("") {
     // Search Directory Defaults To CWD
@@ -19,9 +97,32 @@ void vio::IOManager::setSearchDirectory(const Path& s) {
 }
 void vio::IOManager::setCurrentWorkingDirectory(const Path& s) {
     m_pathCWD = s;
+    invalidatePathCache();
 }
 void vio::IOManager::setExecutableDirectory(const Path& s) {
     m_pathExec = s;
+    invalidatePathCache();
+}
+
+void vio::IOManager::invalidatePathCache() {
+    std::lock_guard<std::mutex> lock(pathCacheLock);
+    pathCache.clear();
+}
+void vio::IOManager::invalidatePathCache(const Path& path) {
+    std::lock_guard<std::mutex> lock(pathCacheLock);
+    const nString& target = path.getString();
+    bool isAbsolute = path.isAbsolute();
+    for (auto it = pathCache.begin(); it != pathCache.end();) {
+        const nString& key = it->first;
+        size_t start = key.find('\0') + 1;
+        // An absolute path may be what any relative path it ends with resolves to
+        bool matches = isAbsolute ? endsWithPath(target, key, start) : key.compare(start, nString::npos, target) == 0;
+        if (matches) {
+            it = pathCache.erase(it);
+        } else {
+            it++;
+        }
+    }
 }
 
 void vio::IOManager::getDirectoryEntries(const Path& dirPath, DirectoryEntries& entries) const {
@@ -31,7 +132,47 @@ void vio::IOManager::getDirectoryEntries(const Path& dirPath, DirectoryEntries&
     }
 }
 
+bool vio::IOManager::mountPack(const Path& path) const {
+    Path packPath;
+    if (!resolvePath(path, packPath)) return false;
+    std::shared_ptr<PackFile> pack(new PackFile);
+    if (!pack->open(packPath)) return false;
+
+    std::lock_guard<std::mutex> lock(packLock);
+    std::shared_ptr<PackList> packs(new PackList);
+    packs->push_back(pack);
+    if (mountedPacks) packs->insert(packs->end(), mountedPacks->begin(), mountedPacks->end());
+    mountedPacks = packs;
+    return true;
+}
+bool vio::IOManager::unmountPack(const Path& path) const {
+    Path packPath;
+    if (!resolvePath(path, packPath)) return false;
+
+    std::lock_guard<std::mutex> lock(packLock);
+    if (!mountedPacks) return false;
+    std::shared_ptr<PackList> packs(new PackList);
+    for (auto& pack : *mountedPacks) {
+        if (pack->getPath().getString() != packPath.getString()) packs->push_back(pack);
+    }
+    if (packs->size() == mountedPacks->size()) return false;
+    if (packs->empty()) packs.reset();
+    mountedPacks = packs;
+    return true;
+}
+void vio::IOManager::unmountAllPacks() {
+    std::lock_guard<std::mutex> lock(packLock);
+    mountedPacks.reset();
+}
+
 vio::FileStream vio::IOManager::openFile(const Path& path, const FileOpenFlags& flags) const {
+    // Packs are read-only
+    if ((flags | FileOpenFlags::BINARY) == (FileOpenFlags::READ_ONLY_EXISTING | FileOpenFlags::BINARY)) {
+        std::shared_ptr<PackFile> pack;
+        const PackEntry* entry = findPacked(m_pathSearch, path, pack);
+        if (entry) return PackFile::openStream(pack, *entry);
+    }
+
     Path filePath;
     if ((flags & FileOpenFlags::CREATE) != FileOpenFlags::NONE) {
         if (!assurePath(path, filePath, IOManagerDirectory::SEARCH, true)) return FileStream();
@@ -46,6 +187,14 @@ vio::FileStream vio::IOManager::openFile(const Path& path, const FileOpenFlags&
 }
 
 bool vio::IOManager::readFileToString(const Path& path, nString& data) const {
+    std::shared_ptr<PackFile> pack;
+    const PackEntry* entry = findPacked(m_pathSearch, path, pack);
+    if (entry) {
+        data.resize((size_t)entry->size + 1);
+        data[(size_t)entry->size] = 0;
+        return pack->read(*entry, (ui8*)&data[0]);
+    }
+
     FileStream fs = openFile(path, FileOpenFlags::READ_ONLY_EXISTING);
     if (!fs.isOpened()) return false;
 
@@ -56,6 +205,16 @@ bool vio::IOManager::readFileToString(const Path& path, nString& data) const {
     return true;
 }
 cString vio::IOManager::readFileToString(const Path& path) const {
+    std::shared_ptr<PackFile> pack;
+    const PackEntry* entry = findPacked(m_pathSearch, path, pack);
+    if (entry) {
+        cString data = new char[(size_t)entry->size + 1];
+        data[(size_t)entry->size] = 0;
+        if (pack->read(*entry, (ui8*)data)) return data;
+        delete[] data;
+        return nullptr;
+    }
+
     FileStream fs = openFile(path, FileOpenFlags::READ_ONLY_EXISTING);
     if (!fs.isOpened()) return nullptr;
 
@@ -66,6 +225,13 @@ cString vio::IOManager::readFileToString(const Path& path) const {
     return data;
 }
 bool vio::IOManager::readFileToData(const Path& path, std::vector<ui8>& data) const {
+    std::shared_ptr<PackFile> pack;
+    const PackEntry* entry = findPacked(m_pathSearch, path, pack);
+    if (entry) {
+        data.resize((size_t)entry->size);
+        return pack->read(*entry, data.data());
+    }
+
     FileStream fs = openFile(path, FileOpenFlags::READ_ONLY_EXISTING | FileOpenFlags::BINARY);
     if (!fs.isOpened()) return false;
 
@@ -75,7 +241,70 @@ bool vio::IOManager::readFileToData(const Path& path, std::vector<ui8>& data) co
     return true;
 }
 
+void vio::IOManager::readFilesAsync(const std::vector<Path>& paths, AsyncReadCallback callback) const {
+    AsyncFileReader::getShared().read(*this, paths, std::move(callback));
+}
+std::future<std::vector<vio::AsyncReadResult> > vio::IOManager::readFilesAsync(const std::vector<Path>& paths) const {
+    return AsyncFileReader::getShared().read(*this, paths);
+}
+bool vio::IOManager::mapFile(const Path& path, OUT MappedFile& file) const {
+    std::shared_ptr<PackFile> pack;
+    const PackEntry* entry = findPacked(m_pathSearch, path, pack);
+    if (entry) {
+        // Stored files are page-aligned, so they map straight out of the pack
+        if (entry->flags & PackEntry::COMPRESSED) return false;
+        return file.open(pack->getPath(), entry->offset, (size_t)entry->size);
+    }
+
+    Path filePath;
+    if (!resolvePath(path, filePath) || !filePath.isFile()) return false;
+    return file.open(filePath);
+}
+
 bool vio::IOManager::resolvePath(const Path& path, Path& resultAbsolutePath) const {
+    bool isFile;
+    return resolveCachedPath(path, resultAbsolutePath, isFile);
+}
+bool vio::IOManager::resolveCachedPath(const Path& path, OUT Path& resultAbsolutePath, OUT bool& isFile) const {
+    nString key = makePathKey(m_pathSearch, path);
+    ResolvedPath resolved;
+    bool cached = false;
+    {
+        std::lock_guard<std::mutex> lock(pathCacheLock);
+        auto it = pathCache.find(key);
+        if (it != pathCache.end() && (it->second.found || m_cacheMisses)) {
+            resolved = it->second;
+            cached = true;
+        }
+    }
+    if (cached) {
+        if (!resolved.found) {
+            isFile = false;
+            return false;
+        }
+        // The entry may have been deleted or replaced outside of a manager, which costs one
+        // check rather than a search
+        if (resolved.isFile ? resolved.path.isFile() : resolved.path.isDirectory()) {
+            resultAbsolutePath = resolved.path;
+            isFile = resolved.isFile;
+            return true;
+        }
+        std::lock_guard<std::mutex> lock(pathCacheLock);
+        pathCache.erase(key);
+    }
+
+    resolved.found = resolvePathUncached(path, resolved.path);
+    resolved.isFile = resolved.found && resolved.path.isFile();
+    if (resolved.found) resultAbsolutePath = resolved.path;
+    isFile = resolved.isFile;
+    if (!resolved.found && !m_cacheMisses) return false;
+
+    std::lock_guard<std::mutex> lock(pathCacheLock);
+    if (pathCache.size() >= MAX_CACHED_PATHS) pathCache.clear();
+    pathCache[key] = resolved;
+    return resolved.found;
+}
+bool vio::IOManager::resolvePathUncached(const Path& path, Path& resultAbsolutePath) const {
     // Special case if the path is already an absolute path
     if (path.isAbsolute()) {
         if (path.isValid()) {
@@ -133,6 +362,7 @@ bool vio::IOManager::assurePath(const Path& path, OUT Path& resultAbsolutePath,
                     path.asFile(&f);
                     f.create(true);
                 }
+                invalidatePathCache(path);
                 resultAbsolutePath = path;
                 return true;
             }
@@ -192,6 +422,7 @@ bool vio::IOManager::assurePath(const Path& path, OUT Path& resultAbsolutePath,
             pSearch.asFile(&f);
             f.create(true);
         }
+        invalidatePathCache(path);
         resultAbsolutePath = pSearch;
         return true;
     }
@@ -205,18 +436,24 @@ bool vio::IOManager::writeStringToFile(const Path& path, const nString& data) co
     if (!fPath.asFile(&f)) return false;
     FileStream fs = f.open(FileOpenFlags::WRITE_ONLY_APPEND);
     if (!fs.isOpened()) return false;
+    invalidatePathCache(path);
     fs.write(data.c_str());
     return true;
 }
 
 bool vio::IOManager::makeDirectory(const Path& path) const {
-    return buildDirectoryTree(m_pathSearch / path, false);
+    bool built = buildDirectoryTree(m_pathSearch / path, false);
+    invalidatePathCache(path);
+    return built;
 }
 
 bool vio::IOManager::fileExists(const Path& path) const {
+    std::shared_ptr<PackFile> pack;
+    if (findPacked(m_pathSearch, path, pack)) return true;
+
     Path res;
-    if (!resolvePath(path, res)) return false;
-    return res.isFile();
+    bool isFile;
+    return resolveCachedPath(path, res, isFile) && isFile;
 }
 bool vio::IOManager::directoryExists(const Path& path) const {
     Path res;
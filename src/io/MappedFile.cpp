@@ -0,0 +1,127 @@
+#include "Vorb/stdafx.h"
+#include "Vorb/io/MappedFile.h"
+
+#ifndef VORB_OS_WINDOWS
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif // !VORB_OS_WINDOWS
+
+vio::MappedFile::MappedFile(MappedFile&& other) :
+    m_data(other.m_data),
+    m_size(other.m_size),
+    m_viewOffset(other.m_viewOffset),
+    m_isOpen(other.m_isOpen),
+    m_mappingHandle(other.m_mappingHandle) {
+    other.m_data = nullptr;
+    other.m_size = 0;
+    other.m_viewOffset = 0;
+    other.m_isOpen = false;
+    other.m_mappingHandle = nullptr;
+}
+
+vio::MappedFile& vio::MappedFile::operator=(MappedFile&& other) {
+    if (this != &other) {
+        close();
+        std::swap(m_data, other.m_data);
+        std::swap(m_size, other.m_size);
+        std::swap(m_viewOffset, other.m_viewOffset);
+        std::swap(m_isOpen, other.m_isOpen);
+        std::swap(m_mappingHandle, other.m_mappingHandle);
+    }
+    return *this;
+}
+
+bool vio::MappedFile::open(const Path& path) {
+    return map(path, 0, 0, true);
+}
+bool vio::MappedFile::open(const Path& path, ui64 offset, size_t size) {
+    return map(path, offset, size, false);
+}
+
+bool vio::MappedFile::map(const Path& path, ui64 offset, size_t size, bool toEnd) {
+    close();
+
+#ifdef VORB_OS_WINDOWS
+    // Other handles may keep writing to the file
+    HANDLE file = CreateFileA(path.getCString(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                              nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || offset > (ui64)fileSize.QuadPart ||
+        (!toEnd && size > (ui64)fileSize.QuadPart - offset)) {
+        CloseHandle(file);
+        return false;
+    }
+    m_size = toEnd ? (size_t)((ui64)fileSize.QuadPart - offset) : size;
+
+    // Views must start on the allocation granularity
+    SYSTEM_INFO system;
+    GetSystemInfo(&system);
+    ui64 viewStart = offset - offset % system.dwAllocationGranularity;
+    m_viewOffset = (size_t)(offset - viewStart);
+
+    // Empty ranges cannot be mapped
+    if (m_size > 0) {
+        HANDLE mapping = CreateFileMapping(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping != NULL) {
+            const ui8* view = (const ui8*)MapViewOfFile(mapping, FILE_MAP_READ, (DWORD)(viewStart >> 32), (DWORD)viewStart, m_viewOffset + m_size);
+            if (view) {
+                m_data = view + m_viewOffset;
+                m_mappingHandle = mapping;
+            } else {
+                CloseHandle(mapping);
+            }
+        }
+    }
+    // The mapping keeps the file open
+    CloseHandle(file);
+#else
+    int fd = ::open(path.getCString(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat info;
+    if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode) || offset > (ui64)info.st_size ||
+        (!toEnd && size > (ui64)info.st_size - offset)) {
+        ::close(fd);
+        return false;
+    }
+    m_size = toEnd ? (size_t)((ui64)info.st_size - offset) : size;
+
+    // Views must start on a page
+    ui64 viewStart = offset - offset % (ui64)sysconf(_SC_PAGESIZE);
+    m_viewOffset = (size_t)(offset - viewStart);
+
+    // Empty ranges cannot be mapped
+    if (m_size > 0) {
+        void* view = mmap(nullptr, m_viewOffset + m_size, PROT_READ, MAP_SHARED, fd, (off_t)viewStart);
+        m_data = view == MAP_FAILED ? nullptr : (const ui8*)view + m_viewOffset;
+    }
+    // The mapping keeps the file open
+    ::close(fd);
+#endif // VORB_OS_WINDOWS
+
+    if (m_size > 0 && !m_data) {
+        m_size = 0;
+        m_viewOffset = 0;
+        return false;
+    }
+    m_isOpen = true;
+    return true;
+}
+
+void vio::MappedFile::close() {
+    if (m_data) {
+#ifdef VORB_OS_WINDOWS
+        UnmapViewOfFile(m_data - m_viewOffset);
+        CloseHandle((HANDLE)m_mappingHandle);
+#else
+        munmap((void*)(m_data - m_viewOffset), m_viewOffset + m_size);
+#endif // VORB_OS_WINDOWS
+    }
+    m_data = nullptr;
+    m_size = 0;
+    m_viewOffset = 0;
+    m_isOpen = false;
+    m_mappingHandle = nullptr;
+}
@@ -0,0 +1,288 @@
+#include "Vorb/stdafx.h"
+#include "Vorb/io/PackFile.h"
+
+#include "Vorb/io/Compression.h"
+
+#include <cstring>
+
+#ifndef VORB_OS_WINDOWS
+#include <sys/types.h>
+#endif // !VORB_OS_WINDOWS
+
+namespace {
+    inline bool seek(FILE* file, ui64 offset) {
+#ifdef VORB_OS_WINDOWS
+        return _fseeki64(file, (__int64)offset, SEEK_SET) == 0;
+#else
+        return fseeko(file, (off_t)offset, SEEK_SET) == 0;
+#endif
+    }
+
+    inline ui64 alignToPage(ui64 offset) {
+        return (offset + vio::PackFormat::PAGE_SIZE - 1) & ~(vio::PackFormat::PAGE_SIZE - 1);
+    }
+}
+
+nString vio::PackFormat::normalizeName(const nString& name) {
+    nString normalized = name;
+    for (auto& c : normalized) {
+        if (c == '\\') c = '/';
+    }
+    size_t start = 0;
+    while (normalized.compare(start, 2, "./") == 0) start += 2;
+    return normalized.substr(start);
+}
+
+ui64 vio::PackFormat::hashName(const nString& name) {
+    // 64-bit FNV-1a
+    ui64 hash = 14695981039346656037ull;
+    for (char c : name) {
+        hash ^= (ui8)c;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+/************************************************************************/
+/* PackFile                                                             */
+/************************************************************************/
+
+bool vio::PackFile::open(const Path& path) {
+    close();
+    if (!m_mapping.open(path)) return false;
+
+    // Validate everything lookups rely on, so a damaged pack can't cause reads outside the mapping
+    const ui8* data = m_mapping.getData();
+    ui64 size = m_mapping.getSize();
+    PackFormat::Header header;
+    if (size < sizeof(header)) {
+        close();
+        return false;
+    }
+    memcpy(&header, data, sizeof(header));
+    ui64 entriesSize = (ui64)header.entryCount * sizeof(PackEntry);
+    ui64 tableBytes = (ui64)header.tableSize * sizeof(ui32);
+    if (header.magic != PackFormat::MAGIC || header.version != PackFormat::VERSION ||
+        header.tableSize <= header.entryCount || (header.tableSize & (header.tableSize - 1)) ||
+        header.indexOffset % PackFormat::PAGE_SIZE ||
+        header.indexOffset > size || entriesSize + tableBytes + header.namesSize > size - header.indexOffset) {
+        close();
+        return false;
+    }
+
+    m_entries = (const PackEntry*)(data + header.indexOffset);
+    m_table = (const ui32*)(data + header.indexOffset + entriesSize);
+    m_names = (const char*)(data + header.indexOffset + entriesSize + tableBytes);
+    for (ui32 i = 0; i < header.entryCount; i++) {
+        const PackEntry& entry = m_entries[i];
+        if (entry.offset > header.indexOffset || entry.storedSize > header.indexOffset - entry.offset ||
+            (ui64)entry.nameOffset + entry.nameLength > header.namesSize ||
+            // A compressed block expands at most 255 times
+            ((entry.flags & PackEntry::COMPRESSED) ? entry.size / 255 > entry.storedSize : entry.storedSize != entry.size)) {
+            close();
+            return false;
+        }
+    }
+    for (ui32 i = 0; i < header.tableSize; i++) {
+        if (m_table[i] > header.entryCount) {
+            close();
+            return false;
+        }
+    }
+
+    m_entryCount = header.entryCount;
+    m_tableMask = header.tableSize - 1;
+    m_path = path;
+    return true;
+}
+
+void vio::PackFile::close() {
+    m_mapping.close();
+    m_entries = nullptr;
+    m_table = nullptr;
+    m_names = nullptr;
+    m_entryCount = 0;
+    m_tableMask = 0;
+}
+
+const vio::PackEntry* vio::PackFile::find(const nString& name) const {
+    if (!m_table) return nullptr;
+    nString normalized = PackFormat::normalizeName(name);
+    ui64 hash = PackFormat::hashName(normalized);
+
+    // The table always has an empty slot, which ends the probe
+    for (ui32 slot = (ui32)hash & m_tableMask; m_table[slot]; slot = (slot + 1) & m_tableMask) {
+        const PackEntry& entry = m_entries[m_table[slot] - 1];
+        if (entry.hash == hash && entry.nameLength == normalized.size() &&
+            memcmp(m_names + entry.nameOffset, normalized.data(), normalized.size()) == 0) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+bool vio::PackFile::read(const nString& name, OUT std::vector<ui8>& data) const {
+    const PackEntry* entry = find(name);
+    if (!entry) return false;
+    data.resize((size_t)entry->size);
+    return read(*entry, data.data());
+}
+
+bool vio::PackFile::read(const PackEntry& entry, OUT ui8* data) const {
+    const ui8* stored = m_mapping.getData() + entry.offset;
+    if (entry.flags & PackEntry::COMPRESSED) {
+        return decompressBlock(stored, (size_t)entry.storedSize, data, (size_t)entry.size) == entry.size;
+    }
+    if (entry.size) memcpy(data, stored, (size_t)entry.size);
+    return true;
+}
+
+const ui8* vio::PackFile::view(const nString& name, OUT size_t& size) const {
+    const PackEntry* entry = find(name);
+    if (!entry || (entry->flags & PackEntry::COMPRESSED)) return nullptr;
+    size = (size_t)entry->size;
+    return m_mapping.getData() + entry->offset;
+}
+
+vio::FileStream vio::PackFile::openStream(const nString& name) const {
+    const PackEntry* entry = find(name);
+    if (!entry) return FileStream();
+    return openCopiedStream(*entry);
+}
+
+vio::FileStream vio::PackFile::openStream(const std::shared_ptr<const PackFile>& pack, const PackEntry& entry) {
+#ifndef VORB_OS_WINDOWS
+    // Read-only memory streams never write to their buffer
+    if (!(entry.flags & PackEntry::COMPRESSED) && entry.size) {
+        FILE* file = fmemopen((void*)(pack->m_mapping.getData() + entry.offset), (size_t)entry.size, "rb");
+        if (file) {
+            FileStream stream;
+            stream.m_handle.reset(new FileStream::Handle);
+            stream.m_handle->m_file = file;
+            // The stream reads the mapping, which must outlive it
+            stream.m_handle->m_owner = pack;
+            stream.m_fileCached = file;
+            return stream;
+        }
+    }
+#endif // !VORB_OS_WINDOWS
+    return pack->openCopiedStream(entry);
+}
+
+vio::FileStream vio::PackFile::openCopiedStream(const PackEntry& entry) const {
+    std::vector<ui8> data((size_t)entry.size);
+    if (!read(entry, data.data())) return FileStream();
+    FILE* file = tmpfile();
+    if (!file) return FileStream();
+    if (fwrite(data.data(), 1, data.size(), file) != data.size()) {
+        fclose(file);
+        return FileStream();
+    }
+    rewind(file);
+
+    FileStream stream;
+    stream.m_handle.reset(new FileStream::Handle);
+    stream.m_handle->m_file = file;
+    stream.m_fileCached = file;
+    return stream;
+}
+
+nString vio::PackFile::getName(const PackEntry& entry) const {
+    return nString(m_names + entry.nameOffset, entry.nameLength);
+}
+
+/************************************************************************/
+/* PackWriter                                                           */
+/************************************************************************/
+
+vio::PackWriter::~PackWriter() {
+    if (m_file) fclose(m_file);
+}
+
+bool vio::PackWriter::open(const Path& path) {
+    if (m_file) fclose(m_file);
+    m_entries.clear();
+    m_names.clear();
+    m_addedNames.clear();
+    m_failed = false;
+
+    m_file = fopen(path.getCString(), "wb");
+    if (!m_file) return false;
+    // The header is written by finish, data starts on the next page
+    m_offset = PackFormat::PAGE_SIZE;
+    return true;
+}
+
+bool vio::PackWriter::add(const nString& name, const void* data, size_t size, bool compress /*= true*/) {
+    if (!m_file || m_failed) return false;
+    nString normalized = PackFormat::normalizeName(name);
+    if (!m_addedNames.insert(normalized).second) return false;
+
+    PackEntry entry = {};
+    entry.hash = PackFormat::hashName(normalized);
+    entry.offset = alignToPage(m_offset);
+    entry.storedSize = size;
+    entry.size = size;
+    entry.nameOffset = (ui32)m_names.size();
+    entry.nameLength = (ui32)normalized.size();
+
+    // Keep the data raw when compression doesn't pay off
+    const void* stored = data;
+    std::vector<ui8> compressed;
+    if (compress && size) {
+        compressed.resize(compressBound(size));
+        size_t compressedSize = compressBlock((const ui8*)data, size, compressed.data(), compressed.size());
+        if (compressedSize && compressedSize < size) {
+            stored = compressed.data();
+            entry.storedSize = compressedSize;
+            entry.flags |= PackEntry::COMPRESSED;
+        }
+    }
+
+    if (entry.storedSize &&
+        (!seek(m_file, entry.offset) || fwrite(stored, 1, (size_t)entry.storedSize, m_file) != entry.storedSize)) {
+        m_failed = true;
+        return false;
+    }
+    m_offset = entry.offset + entry.storedSize;
+    m_names += normalized;
+    m_entries.push_back(entry);
+    return true;
+}
+
+bool vio::PackWriter::addFile(const nString& name, const Path& source, bool compress /*= true*/) {
+    MappedFile file;
+    if (!file.open(source)) return false;
+    return add(name, file.getData(), file.getSize(), compress);
+}
+
+bool vio::PackWriter::finish() {
+    if (!m_file) return false;
+
+    // Size the table to at most half full, which also keeps an empty slot
+    ui32 tableSize = 1;
+    while (tableSize < m_entries.size() * 2 + 1) tableSize *= 2;
+    std::vector<ui32> table(tableSize, 0);
+    for (size_t i = 0; i < m_entries.size(); i++) {
+        ui32 slot = (ui32)m_entries[i].hash & (tableSize - 1);
+        while (table[slot]) slot = (slot + 1) & (tableSize - 1);
+        table[slot] = (ui32)i + 1;
+    }
+
+    PackFormat::Header header = {};
+    header.magic = PackFormat::MAGIC;
+    header.version = PackFormat::VERSION;
+    header.entryCount = (ui32)m_entries.size();
+    header.tableSize = tableSize;
+    header.indexOffset = alignToPage(m_offset);
+    header.namesSize = m_names.size();
+
+    bool success = !m_failed && seek(m_file, header.indexOffset) &&
+        fwrite(m_entries.data(), sizeof(PackEntry), m_entries.size(), m_file) == m_entries.size() &&
+        fwrite(table.data(), sizeof(ui32), table.size(), m_file) == table.size() &&
+        fwrite(m_names.data(), 1, m_names.size(), m_file) == m_names.size() &&
+        seek(m_file, 0) && fwrite(&header, sizeof(header), 1, m_file) == 1;
+    success = fclose(m_file) == 0 && success;
+    m_file = nullptr;
+    return success;
+}
@@ -163,7 +163,10 @@ time_t vio::Path::getLastModTime() const {
         return 0;
     return fileInfo.st_mtime;
 #else
-    auto fsTime=fs::last_write_time(fs::path(m_path));
+    // Match the Windows branch, a path that vanished has no time rather than throwing
+    fs_error_code ec;
+    auto fsTime=fs::last_write_time(fs::path(m_path), ec);
+    if (ec) return 0;
     return convertToTimeT(fsTime);
 #endif
 }
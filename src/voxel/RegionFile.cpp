@@ -0,0 +1,199 @@
+#include "Vorb/stdafx.h"
+#include "Vorb/voxel/RegionFile.h"
+
+#include "Vorb/io/Compression.h"
+
+#ifndef VORB_OS_WINDOWS
+#include <sys/types.h>
+#endif // !VORB_OS_WINDOWS
+
+namespace {
+    inline bool seek(FILE* file, ui64 offset) {
+#ifdef VORB_OS_WINDOWS
+        return _fseeki64(file, (__int64)offset, SEEK_SET) == 0;
+#else
+        return fseeko(file, (off_t)offset, SEEK_SET) == 0;
+#endif
+    }
+
+    inline ui64 getEnd(FILE* file) {
+#ifdef VORB_OS_WINDOWS
+        _fseeki64(file, 0, SEEK_END);
+        return (ui64)_ftelli64(file);
+#else
+        fseeko(file, 0, SEEK_END);
+        return (ui64)ftello(file);
+#endif
+    }
+}
+
+bool vvox::RegionFile::open(const vio::Path& path, ui32 slotCount) {
+    close();
+    if (slotCount == 0) return false;
+
+    Header header;
+    if (path.isFile()) {
+        m_file = fopen(path.getCString(), "rb+");
+        if (!m_file) return false;
+
+        m_slots.resize(slotCount);
+        if (fread(&header, sizeof(Header), 1, m_file) != 1 ||
+            header.magic != MAGIC || header.version != VERSION || header.slotCount != slotCount ||
+            fread(m_slots.data(), sizeof(RegionSlot), slotCount, m_file) != slotCount) {
+            close();
+            return false;
+        }
+        m_fileSize = getEnd(m_file);
+
+        for (auto& slot : m_slots) {
+            if (!slot.offset) continue;
+            // Raw blobs keep their size and a compressed block expands at most 255 times
+            bool plausibleSize = slot.compressedSize == slot.uncompressedSize ||
+                (slot.compressedSize < slot.uncompressedSize && slot.uncompressedSize / 255 <= slot.compressedSize);
+            if (slot.offset < getDataStart() || slot.offset > m_fileSize ||
+                slot.compressedSize > m_fileSize - slot.offset || !plausibleSize) {
+                close();
+                return false;
+            }
+            m_liveBytes += slot.compressedSize;
+        }
+    } else {
+        m_file = fopen(path.getCString(), "wb+");
+        if (!m_file) return false;
+
+        header.magic = MAGIC;
+        header.version = VERSION;
+        header.slotCount = slotCount;
+        header.reserved = 0;
+        m_slots.assign(slotCount, RegionSlot{ 0, 0, 0 });
+        if (fwrite(&header, sizeof(Header), 1, m_file) != 1 ||
+            fwrite(m_slots.data(), sizeof(RegionSlot), slotCount, m_file) != slotCount ||
+            fflush(m_file) != 0) {
+            close();
+            return false;
+        }
+        m_fileSize = getDataStart();
+    }
+
+    m_path = path;
+    return true;
+}
+
+void vvox::RegionFile::close() {
+    m_mapping.close();
+    if (m_file) {
+        fclose(m_file);
+        m_file = nullptr;
+    }
+    std::vector<RegionSlot>().swap(m_slots);
+    std::vector<ui8>().swap(m_buffer);
+    m_fileSize = 0;
+    m_liveBytes = 0;
+}
+
+bool vvox::RegionFile::write(ui32 slot, const void* data, size_t size) {
+    if (!m_file || slot >= m_slots.size() || size > UINT32_MAX) return false;
+
+    // Keep the blob raw when compression doesn't pay off
+    const ui8* blob = (const ui8*)data;
+    m_buffer.resize(vio::compressBound(size));
+    size_t compressedSize = vio::compressBlock(blob, size, m_buffer.data(), m_buffer.size());
+    if (compressedSize && compressedSize < size) {
+        blob = m_buffer.data();
+    } else {
+        compressedSize = size;
+    }
+
+    // Append the blob before pointing the table at it
+    RegionSlot entry = { m_fileSize, (ui32)compressedSize, (ui32)size };
+    if (!seek(m_file, m_fileSize) || fwrite(blob, 1, compressedSize, m_file) != compressedSize) return false;
+    m_fileSize += compressedSize;
+
+    m_liveBytes -= m_slots[slot].compressedSize;
+    m_slots[slot] = entry;
+    m_liveBytes += compressedSize;
+    return writeSlot(slot);
+}
+
+bool vvox::RegionFile::read(ui32 slot, OUT std::vector<ui8>& data) {
+    if (!has(slot)) return false;
+    const RegionSlot& entry = m_slots[slot];
+    data.resize(entry.uncompressedSize);
+    if (entry.compressedSize == 0) return true;
+
+    if (entry.offset + entry.compressedSize > m_mapping.getSize()) {
+        // The file may have been truncated since it was opened
+        if (!m_mapping.open(m_path) || entry.offset + entry.compressedSize > m_mapping.getSize()) return false;
+    }
+    const ui8* blob = m_mapping.getData() + entry.offset;
+    if (entry.compressedSize == entry.uncompressedSize) {
+        memcpy(data.data(), blob, entry.compressedSize);
+        return true;
+    }
+    return vio::decompressBlock(blob, entry.compressedSize, data.data(), data.size()) == data.size();
+}
+
+bool vvox::RegionFile::erase(ui32 slot) {
+    if (!has(slot)) return false;
+    m_liveBytes -= m_slots[slot].compressedSize;
+    m_slots[slot] = RegionSlot{ 0, 0, 0 };
+    return writeSlot(slot);
+}
+
+bool vvox::RegionFile::compact() {
+    if (!m_file) return false;
+    if (m_liveBytes && !m_mapping.open(m_path)) return false;
+
+    // Write live blobs back to back into a new file
+    nString tempPath = m_path.getString() + ".tmp";
+    FILE* temp = fopen(tempPath.c_str(), "wb");
+    if (!temp) return false;
+
+    Header header = { MAGIC, VERSION, (ui32)m_slots.size(), 0 };
+    std::vector<RegionSlot> slots(m_slots.size());
+    ui64 offset = getDataStart();
+    for (size_t i = 0; i < m_slots.size(); i++) {
+        slots[i] = m_slots[i];
+        if (!slots[i].offset) continue;
+        slots[i].offset = offset;
+        offset += slots[i].compressedSize;
+    }
+    bool success = fwrite(&header, sizeof(Header), 1, temp) == 1 &&
+        fwrite(slots.data(), sizeof(RegionSlot), slots.size(), temp) == slots.size();
+    for (size_t i = 0; success && i < m_slots.size(); i++) {
+        if (!m_slots[i].offset) continue;
+        success = fwrite(m_mapping.getData() + m_slots[i].offset, 1, m_slots[i].compressedSize, temp) == m_slots[i].compressedSize;
+    }
+    success = fclose(temp) == 0 && success;
+    if (!success) {
+        remove(tempPath.c_str());
+        return false;
+    }
+
+    // Swap the new file in, the mapping must be gone before the old file is replaced
+    vio::Path path = m_path;
+    ui32 slotCount = (ui32)m_slots.size();
+    close();
+#ifdef VORB_OS_WINDOWS
+    // Windows cannot rename over an existing file
+    remove(path.getCString());
+#endif
+    if (rename(tempPath.c_str(), path.getCString()) != 0) {
+        remove(tempPath.c_str());
+        open(path, slotCount);
+        return false;
+    }
+    return open(path, slotCount);
+}
+
+bool vvox::RegionFile::compactIfNeeded(f32 maxWaste /*= 0.25f*/) {
+    if (!m_file || (f64)getWastedBytes() <= (f64)maxWaste * (f64)m_fileSize) return false;
+    return compact();
+}
+
+bool vvox::RegionFile::writeSlot(ui32 slot) {
+    ui64 offset = sizeof(Header) + (ui64)slot * sizeof(RegionSlot);
+    return seek(m_file, offset) &&
+        fwrite(&m_slots[slot], sizeof(RegionSlot), 1, m_file) == 1 &&
+        fflush(m_file) == 0;
+}
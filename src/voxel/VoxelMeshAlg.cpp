@@ -0,0 +1,120 @@
+#include "Vorb/stdafx.h"
+#include "Vorb/voxel/VoxelMeshAlg.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+
+#include "Vorb/graphics/GLEnums.h"
+#include "Vorb/graphics/GpuMemory.h"
+#include "Vorb/graphics/gtypes.h"
+#include "Vorb/VorbAssert.hpp"
+
+// The header returns buffers as ui32 to stay free of GL
+static_assert(std::is_same<VGIndexBuffer, ui32>::value, "VGIndexBuffer must be a ui32");
+
+namespace {
+    /// Lazily grown index pattern of a single index type
+    template<typename T>
+    class QuadIndexPattern {
+    public:
+        QuadIndexPattern(ui32 maxQuads) :
+            m_maxQuads(maxQuads) {
+            // Empty
+        }
+
+        const T* get(ui32 quads) {
+            vorb_assert(quads <= m_maxQuads, "Too many quads for the index pattern");
+            if (quads > m_maxQuads) return nullptr;
+            Generation* current = m_current.load(std::memory_order_acquire);
+            if (current && current->quads >= quads) return current->indices.get();
+            return grow(quads)->indices.get();
+        }
+
+        VGIndexBuffer getBuffer(ui32 quads) {
+            vorb_assert(quads <= m_maxQuads, "Too many quads for the index pattern");
+            if (quads > m_maxQuads) return 0;
+            if (m_buffer && m_bufferQuads >= quads) return m_buffer;
+
+            Generation* generation = grow(quads);
+            // Binding the index buffer would replace the one of a VAO the caller has bound
+            GLint vao = 0;
+            glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &vao);
+            if (vao) glBindVertexArray(0);
+            if (!m_buffer) vg::GpuMemory::createBuffer(m_buffer);
+            vg::GpuMemory::bindBuffer(m_buffer, vg::BufferTarget::ELEMENT_ARRAY_BUFFER);
+            vg::GpuMemory::uploadBufferData(m_buffer, vg::BufferTarget::ELEMENT_ARRAY_BUFFER,
+                                            generation->quads * 6 * sizeof(T), generation->indices.get());
+            vg::GpuMemory::bindBuffer(0, vg::BufferTarget::ELEMENT_ARRAY_BUFFER);
+            if (vao) glBindVertexArray((GLuint)vao);
+            m_bufferQuads = generation->quads;
+            return m_buffer;
+        }
+
+        void freeBuffer() {
+            if (!m_buffer) return;
+            vg::GpuMemory::freeBuffer(m_buffer);
+            m_bufferQuads = 0;
+        }
+    private:
+        struct Generation {
+            ui32 quads;
+            std::unique_ptr<T[]> indices;
+        };
+
+        Generation* grow(ui32 quads) {
+            std::lock_guard<std::mutex> lock(m_lock);
+            Generation* current = m_current.load(std::memory_order_relaxed);
+            if (current && current->quads >= quads) return current;
+
+            // Double to keep regeneration rare, older generations stay alive for existing readers
+            ui32 size = current ? current->quads : 1024;
+            while (size < quads) size *= 2;
+            if (size > m_maxQuads) size = m_maxQuads;
+
+            Generation* generation = new Generation;
+            generation->quads = size;
+            generation->indices.reset(vvox::meshalg::generateQuadIndices<T>(size));
+            m_generations.emplace_back(generation);
+            m_current.store(generation, std::memory_order_release);
+            return generation;
+        }
+
+        const ui32 m_maxQuads;
+        std::atomic<Generation*> m_current = ATOMIC_VAR_INIT(nullptr);
+        std::mutex m_lock;
+        std::vector<std::unique_ptr<Generation> > m_generations;
+        VGIndexBuffer m_buffer = 0;
+        ui32 m_bufferQuads = 0;
+    };
+
+    QuadIndexPattern<ui16>& pattern16() {
+        static QuadIndexPattern<ui16> pattern(vvox::meshalg::MAX_QUADS_INDEX16);
+        return pattern;
+    }
+    QuadIndexPattern<ui32>& pattern32() {
+        // Keep 6 * quads * 4 bytes addressable by ui32 sizes
+        static QuadIndexPattern<ui32> pattern(1u << 27);
+        return pattern;
+    }
+}
+
+const ui16* vvox::meshalg::SharedQuadIndices::get16(ui32 quads) {
+    return pattern16().get(quads);
+}
+const ui32* vvox::meshalg::SharedQuadIndices::get32(ui32 quads) {
+    return pattern32().get(quads);
+}
+
+ui32 vvox::meshalg::SharedQuadIndices::getBuffer16(ui32 quads) {
+    return pattern16().getBuffer(quads);
+}
+ui32 vvox::meshalg::SharedQuadIndices::getBuffer32(ui32 quads) {
+    return pattern32().getBuffer(quads);
+}
+void vvox::meshalg::SharedQuadIndices::freeBuffers() {
+    pattern16().freeBuffer();
+    pattern32().freeBuffer();
+}
@@ -2,6 +2,34 @@
 #include "Vorb/voxel/VoxelTextureStitcher.h"
 #include "Vorb/ecs/BitTable.hpp"
 
+#include <algorithm>
+
+#if defined(VORB_COMPILER_MSVC)
+#include <intrin.h>
+#endif
+
+namespace {
+    inline ui32 countTrailingZeros(ui64 v) {
+#if defined(VORB_COMPILER_MSVC) && defined(VORB_ARCH_64)
+        unsigned long i;
+        _BitScanForward64(&i, v);
+        return (ui32)i;
+#elif defined(VORB_COMPILER_MSVC)
+        unsigned long i;
+        if (_BitScanForward(&i, (ui32)v)) return (ui32)i;
+        _BitScanForward(&i, (ui32)(v >> 32));
+        return (ui32)i + 32;
+#else
+        return (ui32)__builtin_ctzll(v);
+#endif
+    }
+
+    /// @return Mask of the lowest count bits, count may be 64
+    inline ui64 lowBits(ui32 count) {
+        return count >= 64 ? ~0ull : ((1ull << count) - 1);
+    }
+}
+
 vvox::VoxelTextureStitcher::VoxelTextureStitcher(ui32 tilesPerRow /*= 16u*/) {
     m_tilesPerRow = tilesPerRow;
     m_tilesPerPage = tilesPerRow * tilesPerRow;
@@ -12,31 +40,17 @@ vvox::VoxelTextureStitcher::VoxelTextureStitcher(ui32 tilesPerRow /*= 16u*/) {
 }
 
 vvox::VoxelTextureStitcher::~VoxelTextureStitcher() {
-    for (auto page : m_pages) delete[] page;
+    // Empty
 }
 
 ui32 vvox::VoxelTextureStitcher::mapSingle() {
-    ui32 i;
-    ui32 pageIndex;
-
-    // Find the next free slot
-    do {
-        i = m_oldestFreeSlot % m_tilesPerPage;
-        pageIndex = m_oldestFreeSlot / m_tilesPerPage;
-
-        // If we need to allocate a new page
-        if (pageIndex >= m_pages.size()) {
-            addPage();
-        }
-
-        // Since we are mapping single textures, we know this is the oldest free
-        m_oldestFreeSlot++;
-    } while (m_pages[pageIndex][i] == true);
+    // Since we are mapping single textures, we know this is the oldest free
+    ui32 index = findFree(m_oldestFreeSlot);
+    m_oldestFreeSlot = index + 1;
 
     //mark this slot as not free
-    m_pages[pageIndex][i] = true;
-
-    return pageIndex * m_tilesPerPage + i;
+    markUsed(index, 1);
+    return index;
 }
 
 ui32 vvox::VoxelTextureStitcher::mapBox(ui32 width, ui32 height) {
@@ -44,127 +58,173 @@ ui32 vvox::VoxelTextureStitcher::mapBox(ui32 width, ui32 height) {
         return -1;
     }
 
-    ui32 i;
-    ui32 pageIndex;
-    ui32 x, y;
-
-    // Start the search at the oldest known free spot.
-    ui32 searchIndex = m_oldestFreeSlot;
-    bool fits;
+    // Slots are never freed, so positions skipped by the last search for this shape still don't fit
+    ui32& shapeStart = m_boxStarts[((ui64)width << 32) | height];
+    ui32 searchIndex = std::max(m_oldestFreeSlot, shapeStart);
 
-    // Find the next free slot that is large enough
     while (true) {
-        i = searchIndex % m_tilesPerPage;
-        pageIndex = searchIndex / m_tilesPerPage;
-        x = i % m_tilesPerRow;
-        y = i / m_tilesPerRow;
-        fits = true;
-
-        // If we need to allocate a new atlas
-        if (pageIndex >= m_pages.size()) {
-            addPage();
-        }
+        ui32 pageIndex = searchIndex / m_tilesPerPage;
+        ui32 i = searchIndex % m_tilesPerPage;
 
-        //if it doesn't fit in Y direction, go to next page
-        if (y + height > m_tilesPerRow) {
+        // Skip pages that don't have enough room left
+        if (pageIndex < m_freeSlots.size() && m_freeSlots[pageIndex] < width * height) {
             searchIndex += m_tilesPerPage - i;
             continue;
         }
-        //if it doesn't fit in X direction, go to next row
-        if (x + width > m_tilesPerRow) {
-            searchIndex += m_tilesPerRow - x;
-            continue;
-        }
 
-        searchIndex++;
-
-        //Search to see if all needed slots are free
-        for (ui32 j = y; j < y + height; j++) {
-            for (ui32 k = x; k < x + width; k++) {
-                if (m_pages[pageIndex][j * m_tilesPerRow + k] == true) {
-                    fits = false;
-                    j = y + height; //force to fall out of loop
-                    break;
+        ui32 x = i % m_tilesPerRow;
+        for (ui32 y = i / m_tilesPerRow; y + height <= m_tilesPerRow; y++) {
+            ui32 rowIndex = pageIndex * m_tilesPerPage + y * m_tilesPerRow;
+            x = findBoxInRow(rowIndex, x, width, height);
+            if (x < m_tilesPerRow) {
+                //if we reach here, it will fit at this position
+                ui32 index = rowIndex + x;
+                for (ui32 j = 0; j < height; j++) {
+                    markUsed(index + j * m_tilesPerRow, width);
                 }
+                shapeStart = index;
+                return index;
             }
+            x = 0;
         }
 
-        if (fits) {
-            //if we reach here, it will fit at this position
-            break;
-        }
+        //if it doesn't fit in Y direction, go to next page
+        searchIndex += m_tilesPerPage - i;
     }
+}
 
-    //Set all slots to true
-    for (ui32 j = y; j < y + height; j++) {
-        for (ui32 k = x; k < x + width; k++) {
-            m_pages[pageIndex][j * m_tilesPerRow + k] = true;
-        }
+ui32 vvox::VoxelTextureStitcher::mapContiguous(ui32 numTiles) {
+    // Slots are never freed, so runs that were too short for this length still are
+    ui32& lengthStart = m_contiguousStarts[numTiles];
+    ui32 firstFree = findFree(m_oldestFreeSlot);
+    ui32 index = findFree(std::max(firstFree, lengthStart));
+
+    // Find the next free run that is large enough
+    while (true) {
+        ui32 end = findUsed(index, index + numTiles);
+        if (end - index >= numTiles) break;
+        index = findFree(end);
     }
 
-    return i + pageIndex * m_tilesPerPage;
+    // Move the oldest known free slot forward if we havent passed a free spot
+    if (index == firstFree) {
+        m_oldestFreeSlot = index + numTiles;
+    }
+
+    // Mark slots as full
+    markUsed(index, numTiles);
+    lengthStart = index + numTiles;
+    return index;
 }
 
-ui32 vvox::VoxelTextureStitcher::mapContiguous(ui32 numTiles) {
+void vvox::VoxelTextureStitcher::dispose() {
+    std::vector<ui64>().swap(m_slots);
+    std::vector<ui32>().swap(m_freeSlots);
+    std::unordered_map<ui32, ui32>().swap(m_contiguousStarts);
+    std::unordered_map<ui64, ui32>().swap(m_boxStarts);
+}
 
-    ui32 i;
-    ui32 pageIndex;
-    ui32 numContiguous = 0;
-    // Start the search at the oldest known free spot.
-    ui32 searchIndex = m_oldestFreeSlot;
-    bool passedFreeSlot = false;
+void vvox::VoxelTextureStitcher::addPage() {
+    m_freeSlots.push_back(m_tilesPerPage);
+    m_slots.resize((m_freeSlots.size() * m_tilesPerPage + 63) / 64, 0);
+}
 
-    // Find the next free slot that is large enough
-    while (true) {
-        i = searchIndex % m_tilesPerPage;
-        pageIndex = searchIndex / m_tilesPerPage;
+ui32 vvox::VoxelTextureStitcher::findFree(ui32 index) const {
+    size_t word = index / 64;
+    if (word >= m_slots.size()) return index;
 
-        // If we need to allocate a new atlas
-        if (pageIndex >= m_pages.size()) {
-            addPage();
-        }
+    ui64 free = ~m_slots[word] & (~0ull << (index % 64));
+    while (!free) {
+        if (++word == m_slots.size()) return (ui32)(word * 64);
+        free = ~m_slots[word];
+    }
+    return (ui32)(word * 64) + countTrailingZeros(free);
+}
 
-        searchIndex++;
-        if (m_pages[pageIndex][i] == true) {
-            // If we have any contiguous, then we left a free spot behind somewhere
-            if (numContiguous) {
-                passedFreeSlot = true;
-            }
-            numContiguous = 0;
-        } else {
-            numContiguous++;
-        }
+ui32 vvox::VoxelTextureStitcher::findUsed(ui32 index, ui32 limit) const {
+    size_t word = index / 64;
+    if (index >= limit || word >= m_slots.size()) return limit;
 
-        // Stop searching if we have found a contiguous block that is large enough
-        if (numContiguous == numTiles) {
-            i = searchIndex % m_tilesPerPage;
-            pageIndex = searchIndex / m_tilesPerPage;
-            break;
-        }
+    ui64 used = m_slots[word] & (~0ull << (index % 64));
+    while (!used) {
+        if (++word == m_slots.size() || word * 64 >= limit) return limit;
+        used = m_slots[word];
     }
+    return std::min((ui32)(word * 64) + countTrailingZeros(used), limit);
+}
 
-    // Move the oldest known free slot forward if we havent passed a free spot
-    if (passedFreeSlot == false) {
-        m_oldestFreeSlot = i + pageIndex * m_tilesPerPage;
-    }
+ui64 vvox::VoxelTextureStitcher::getSlots(ui32 index, ui32 count) const {
+    size_t word = index / 64;
+    ui32 shift = index % 64;
+    if (word >= m_slots.size()) return 0;
 
-    ui32 index = i + pageIndex * m_tilesPerPage - numTiles;
+    ui64 bits = m_slots[word] >> shift;
+    if (shift && word + 1 < m_slots.size()) bits |= m_slots[word + 1] << (64 - shift);
+    return bits & lowBits(count);
+}
 
-    // Mark slots as full
-    for (searchIndex = index; searchIndex < index + numTiles; searchIndex++) {
-        i = searchIndex % m_tilesPerPage;
-        pageIndex = searchIndex / m_tilesPerPage;
-        m_pages[pageIndex][i] = true;
+void vvox::VoxelTextureStitcher::markUsed(ui32 index, ui32 count) {
+    // If we need to allocate a new page
+    while (index + count > m_freeSlots.size() * m_tilesPerPage) {
+        addPage();
     }
 
-    return index;
-}
+    ui32 end = index + count;
+    while (index < end) {
+        ui32 word = index / 64;
+        ui32 shift = index % 64;
+        ui32 bits = std::min(64 - shift, end - index);
+        m_slots[word] |= lowBits(bits) << shift;
+        index += bits;
+    }
 
-void vvox::VoxelTextureStitcher::dispose() {
-    for (auto page : m_pages) delete[] page;
-    std::vector<bool*>().swap(m_pages);
+    // Count per page, a run may span pages
+    index = end - count;
+    while (index < end) {
+        ui32 pageIndex = index / m_tilesPerPage;
+        ui32 pageEnd = std::min((pageIndex + 1) * m_tilesPerPage, end);
+        m_freeSlots[pageIndex] -= pageEnd - index;
+        index = pageEnd;
+    }
 }
 
-void vvox::VoxelTextureStitcher::addPage() {
-    m_pages.push_back(new bool[m_tilesPerPage] {});
-}
\ No newline at end of file
+ui32 vvox::VoxelTextureStitcher::findBoxInRow(ui32 rowIndex, ui32 minX, ui32 width, ui32 height) const {
+    if (minX + width > m_tilesPerRow) return m_tilesPerRow;
+
+    if (m_tilesPerRow <= 64) {
+        // Columns used in any row the box would cover
+        ui64 used = 0;
+        for (ui32 j = 0; j < height; j++) {
+            used |= getSlots(rowIndex + j * m_tilesPerRow, m_tilesPerRow);
+        }
+
+        // Keep columns that start width free columns, doubling the checked run each step
+        ui64 fits = ~used & lowBits(m_tilesPerRow);
+        ui32 run = 1;
+        while (run * 2 <= width) {
+            fits &= fits >> run;
+            run *= 2;
+        }
+        if (run < width) fits &= fits >> (width - run);
+
+        fits &= lowBits(m_tilesPerRow - width + 1) & ~lowBits(minX);
+        return fits ? countTrailingZeros(fits) : m_tilesPerRow;
+    }
+
+    // Wide pages, skip past the used slot that blocks each candidate
+    ui32 x = minX;
+    while (x + width <= m_tilesPerRow) {
+        bool fits = true;
+        for (ui32 j = 0; j < height; j++) {
+            ui32 start = rowIndex + j * m_tilesPerRow + x;
+            ui32 used = findUsed(start, start + width);
+            if (used < start + width) {
+                x += used - start + 1;
+                fits = false;
+                break;
+            }
+        }
+        if (fits) return x;
+    }
+    return m_tilesPerRow;
+}